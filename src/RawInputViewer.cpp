@@ -19,26 +19,29 @@ BEGIN_ANONYMOUS_NAMESPACE
 class MainWindow final : public Window
 {
 private:
-    [[nodiscard]] bool adjustKeyboardInput(RawKeyboard& rawKbd)
+    [[nodiscard]] KeyboardDisposition adjustKeyboardInput(RawKeyboard& rawKbd)
     {
+        TRACE_SCOPE("adjustKeyboardInput");
+        COUNT_ALLOCATIONS(HotPathStage::Normalize);
+
         // Filter out overruns
         if (rawKbd.MakeCode == KEYBOARD_OVERRUN_MAKE_CODE)
         {
-            return false;
+            return KeyboardDisposition::Overrun;
         }
 
         // Handle Ctrl+{key} sequence
         if ((rawKbd.Flags & RI_KEY_E1) != 0)
         {
             pendingSequence_ = ScanCodeSequence::E1;
-            return false;
+            return KeyboardDisposition::PrefixSwallowed;
         }
 
         // 0xE02A (fake L-shift) indicates the start of an E0 key sequence
         if ((rawKbd.Flags & RI_KEY_E0) != 0 && rawKbd.MakeCode == 0x2A)
         {
             pendingSequence_ = ScanCodeSequence::E0;
-            return false;
+            return KeyboardDisposition::PrefixSwallowed;
         }
 
         const ScanCodeSequence pendingSequence = std::exchange(pendingSequence_, ScanCodeSequence::None);
@@ -53,7 +56,7 @@ private:
 
         if (rawKbd.MakeCode == 0)
         {
-            return false;
+            return KeyboardDisposition::ZeroMakeCode;
         }
 
         if (rawKbd.MakeCode == 0x45)
@@ -108,21 +111,136 @@ private:
             }
         }
 
-        return true;
+        return KeyboardDisposition::Accepted;
     }
 
-    void addKeyEventToListView(const RawKeyboard& rawKbd)
+    void addKeyEventToListView(uint8_t deviceIndex, const RawKeyboard& rawKbd, int64_t time, EventMarkers anomalies)
     {
+        COUNT_ALLOCATIONS(HotPathStage::Store);
+
+        const bool chatters = chatterDetectors_[deviceIndex].onKey(rawKbd.getLookupCode(), rawKbd.isKeyDown, time, getChatterWindow());
         if (const int item = listView_.insertItem(listView_.getItemCount(), rawKbd); item >= 0)
         {
+            // Keep the store in lockstep with the list view, so list view item indexes can be used as store indexes
+            const EventMarkers markers = anomalies | (chatters ? EventMarkers::Chatter : EventMarkers{0});
+            keyboardEvents_.append(deviceIndex, rawKbd.getLookupCode(), rawKbd.isKeyDown, time, markers, rolloverAnalyzers_[deviceIndex].pressed());
             listView_.ensureVisible(item, false);
         }
     }
 
+    // Runs on the adjusted event; anomalies also dump the flight recorder, as the events leading up to them are gone
+    // by the time anyone looks
+    EventMarkers validateKeyboardInput(uint8_t deviceIndex, const RawKeyboard& rawKbd, int64_t time)
+    {
+        const EventMarkers anomalies = validators_[deviceIndex].onKey(rawKbd, time, getStuckKeyThreshold(), virtualKeys_);
+        if (anomalies != EventMarkers{0})
+        {
+            triggerFlightRecorder(FlightRecorder::Trigger::Anomaly);
+        }
+        return anomalies;
+    }
+
+    // Keys that got stuck without sending anything since
+    void sweepStuckKeys() noexcept
+    {
+        const int64_t now = PerformanceCounter::now();
+        uint32_t stuck = 0;
+        validators_.forEach([&](uint8_t, InputValidator& validator) { stuck += validator.sweep(now, getStuckKeyThreshold()); });
+        if (stuck != 0)
+        {
+            triggerFlightRecorder(FlightRecorder::Trigger::Anomaly);
+        }
+    }
+
+    [[nodiscard]] int64_t getStuckKeyThreshold() const noexcept
+    {
+        return PerformanceCounter::frequency() * stuckKeyMilliseconds_ / 1000;
+    }
+
+    [[nodiscard]] int64_t getChatterWindow() const noexcept
+    {
+        return PerformanceCounter::frequency() * chatterWindows_[chatterWindowIndex_] / 1000;
+    }
+
+    void setChatterWindow(size_t index)
+    {
+        chatterWindowIndex_ = index < chatterWindows_.size() ? index : defaultChatterWindowIndex_;
+        const UINT last = static_cast<UINT>(ID_SYSMENU_CHATTER_WINDOW + (chatterWindows_.size() - 1) * 16);
+        CheckMenuRadioItem(chatterWindowMenu_, ID_SYSMENU_CHATTER_WINDOW, last, static_cast<UINT>(ID_SYSMENU_CHATTER_WINDOW + chatterWindowIndex_ * 16), MF_BYCOMMAND);
+
+        // Re-evaluate the events already shown with the new window
+        ChatterDetector::analyze(keyboardEvents_, getChatterWindow(), chatterDetectors_);
+        InvalidateRect(listView_.hwnd(), nullptr, FALSE);
+    }
+
+    void trackKeyHold(uint8_t deviceIndex, const RawKeyboard& rawKbd, int64_t time)
+    {
+        const size_t count = holdIntervals_.size();
+        holdTrackers_[deviceIndex].onKey(deviceIndex, rawKbd.getLookupCode(), rawKbd.isKeyDown, time, holdIntervals_);
+        if (holdIntervals_.size() != count)
+        {
+            const uint64_t duration = PerformanceCounter::toNanoseconds(holdIntervals_.up[count] - holdIntervals_.down[count]);
+            holdDurations_.record(duration);
+
+            (*keyHoldDurations_)[holdIntervals_.key[count] & (KeyHoldTracker::keyCount - 1)].record(duration);
+        }
+    }
+
+    // Without RIDEV_INPUTSINK, key-ups aren't received while in the background
+    void abandonPressedKeys() noexcept
+    {
+        const int64_t now = PerformanceCounter::now();
+        holdTrackers_.forEach([&](uint8_t deviceIndex, KeyHoldTracker& tracker) { tracker.flush(deviceIndex, now, holdIntervals_); });
+        rolloverAnalyzers_.forEach([](uint8_t, RolloverAnalyzer& analyzer) { analyzer.release(); });
+        validators_.forEach([](uint8_t, InputValidator& validator) { validator.release(); });
+    }
+
     void clearListView() noexcept
     {
         listView_.deleteAllItems();
         pendingSequence_ = ScanCodeSequence::None;
+        metrics_.resetDistributions();
+        sourceLatencies_.forEach([](uint8_t, Histogram<>& latencies) { latencies.reset(); });
+        holdIntervals_.clear();
+        holdDurations_.reset();
+        for (Histogram<>& keyDurations : *keyHoldDurations_)
+        {
+            keyDurations.reset();
+        }
+        keyboardEvents_.clear();
+        mouseEvents_.clear();
+        absoluteMouse_.reset();
+        mouseListView_.setItemCount(0);
+        hidReports_.clear();
+        deviceChanges_.clear();
+        chatterDetectors_.forEach([](uint8_t, ChatterDetector& detector) { detector.resetCounts(); });
+        rolloverAnalyzers_.forEach([](uint8_t, RolloverAnalyzer& analyzer) { analyzer.resetStatistics(); });
+        validators_.forEach([](uint8_t, InputValidator& validator) { validator.resetCounts(); });
+        keyboardPolling_.forEach([](uint8_t, PollingEstimator& estimator) { estimator.reset(); });
+        mousePolling_.forEach([](uint8_t, PollingEstimator& estimator) { estimator.reset(); });
+        wheels_.forEach([](uint8_t, WheelAnalyzer& analyzer) { analyzer.reset(); });
+    }
+
+    void updateMetrics()
+    {
+        const InputMetrics::Snapshot snapshot = metrics_.snapshot();
+        const double seconds = static_cast<double>(snapshot.time - lastMetrics_.time) / static_cast<double>(PerformanceCounter::frequency());
+        auto rate = [&](DWORD deviceType)
+        {
+            const uint64_t events = snapshot.events[deviceType] - lastMetrics_.events[deviceType];
+            return seconds > 0.0 ? static_cast<uint64_t>(std::lround(static_cast<double>(events) / seconds)) : uint64_t{0};
+        };
+
+        const Histogram<>& latency = metrics_.latency();
+        const uint64_t keyboardRate = rate(RIM_TYPEKEYBOARD);
+        const uint64_t mouseRate = rate(RIM_TYPEMOUSE);
+        const double p50 = static_cast<double>(latency.valueAtPercentile(50.0)) / 1000.0;
+        const double p99 = static_cast<double>(latency.valueAtPercentile(99.0)) / 1000.0;
+
+        const std::wstring text = std::vformat(metricsFormat_, std::make_wformat_args(keyboardRate, mouseRate, p50, p99, snapshot.dropped, snapshot.overruns));
+        statusBar_.setMetricsText(text.c_str());
+
+        lastMetrics_ = snapshot;
     }
 
     void adjustLayout() noexcept
@@ -136,6 +254,7 @@ private:
 
         statusBar_.move(0, size.cy - statusBarHeight, size.cx, statusBarHeight, TRUE);
         listView_.move(0, toolBarHeight, size.cx, size.cy - toolBarHeight - statusBarHeight, TRUE);
+        mouseListView_.move(0, toolBarHeight, size.cx, size.cy - toolBarHeight - statusBarHeight, TRUE);
     }
 
     [[nodiscard]] WINDOWPLACEMENT getWindowPlacement() const noexcept
@@ -180,6 +299,9 @@ private:
 
     [[nodiscard]] std::optional<LRESULT> getListViewItemDisplayInfo(LVITEMW& item)
     {
+        TRACE_SCOPE("getListViewItemDisplayInfo");
+        COUNT_ALLOCATIONS(HotPathStage::Format);
+
         if ((item.mask & LVIF_TEXT) == 0)
         {
             return std::nullopt;
@@ -279,8 +401,110 @@ private:
         return std::nullopt; // Let DefWindowProcW() deal with unhandled messages
     }
 
+    [[nodiscard]] std::optional<LRESULT> getMouseListViewItemDisplayInfo(LVITEMW& item) const
+    {
+        TRACE_SCOPE("getMouseListViewItemDisplayInfo");
+
+        const size_t index = static_cast<size_t>(item.iItem);
+        if ((item.mask & LVIF_TEXT) == 0 || index >= mouseEvents_.size())
+        {
+            return std::nullopt;
+        }
+
+        switch (item.iSubItem)
+        {
+            case 0:
+            {
+                const int64_t ticks = mouseEvents_.time[index] - mouseEvents_.time[0];
+                const double milliseconds = static_cast<double>(PerformanceCounter::toNanoseconds(ticks)) / 1'000'000.0;
+                *std::format_to_n(item.pszText, item.cchTextMax - 1, L"{:.3f}", milliseconds).out = L'\0';
+                return TRUE;
+            }
+            case 1:
+            {
+                const uintptr_t handle = reinterpret_cast<uintptr_t>(devices_.getHandle(mouseEvents_.device[index]));
+                *std::format_to_n(item.pszText, item.cchTextMax - 1, L"{:#x}", handle).out = L'\0';
+                return TRUE;
+            }
+            case 2:
+            {
+                *std::format_to_n(item.pszText, item.cchTextMax - 1, L"{}", mouseEvents_.dx[index]).out = L'\0';
+                return TRUE;
+            }
+            case 3:
+            {
+                *std::format_to_n(item.pszText, item.cchTextMax - 1, L"{}", mouseEvents_.dy[index]).out = L'\0';
+                return TRUE;
+            }
+            case 4:
+            {
+                *std::format_to_n(item.pszText, item.cchTextMax - 1, L"{:#06x}", mouseEvents_.buttonFlags[index]).out = L'\0';
+                return TRUE;
+            }
+            case 5:
+            {
+                // Only wheel events carry button data
+                const bool hasWheel = (mouseEvents_.buttonFlags[index] & (RI_MOUSE_WHEEL | RI_MOUSE_HWHEEL)) != 0;
+                *std::format_to_n(item.pszText, item.cchTextMax - 1, L"{}", hasWheel ? mouseEvents_.buttonData[index] : SHORT{0}).out = L'\0';
+                return TRUE;
+            }
+            case 6:
+            {
+                *std::format_to_n(item.pszText, item.cchTextMax - 1, L"{:#04x}", mouseEvents_.flags[index]).out = L'\0';
+                return TRUE;
+            }
+        }
+
+        return std::nullopt; // Let DefWindowProcW() deal with unhandled messages
+    }
+
+    // The mouse list view is virtual and only learns about new events here, which batches
+    // updates for high polling rate mice
+    void updateMouseListView() noexcept
+    {
+        normalizeMouseInput();
+        if (mouseListView_.isVisible() && mouseEvents_.size() != 0)
+        {
+            const int count = static_cast<int>(std::min<size_t>(mouseEvents_.size(), std::numeric_limits<int>::max()));
+            mouseListView_.setItemCount(count);
+            mouseListView_.ensureVisible(count - 1, false);
+        }
+    }
+
+    // Absolute mouse events are normalized in batches, like the keyboard input only if adjustments are enabled
+    void normalizeMouseInput() noexcept
+    {
+        TRACE_SCOPE("normalizeMouseInput");
+        if (toolBar_.isAdjustmentChecked())
+        {
+            absoluteMouse_.normalize(mouseEvents_);
+        }
+        else
+        {
+            absoluteMouse_.skip(mouseEvents_);
+        }
+    }
+
+    // A pointer moving between removal and arrival, or another device taking over the index, would otherwise show
+    // the jump from the old position as motion
+    void forgetMousePosition(uint8_t deviceIndex) noexcept
+    {
+        normalizeMouseInput();
+        absoluteMouse_.forget(deviceIndex);
+    }
+
+    void showMouseListView(bool show) noexcept
+    {
+        CheckMenuItem(GetSystemMenu(hwnd_, FALSE), ID_SYSMENU_MOUSE_EVENTS, MF_BYCOMMAND | (show ? MF_CHECKED : MF_UNCHECKED));
+        mouseListView_.setVisible(show);
+        listView_.setVisible(!show);
+        updateMouseListView();
+    }
+
     [[nodiscard]] std::optional<LRESULT> customDrawListViewItem(NMLVCUSTOMDRAW* customDraw)
     {
+        TRACE_SCOPE("customDrawListViewItem");
+
         switch (customDraw->nmcd.dwDrawStage)
         {
             case CDDS_PREPAINT:
@@ -295,13 +519,23 @@ private:
             {
                 const AdjustmentFlags flags = AdjustmentFlags::MakeCodeMapped | AdjustmentFlags::VirtualKeyAdjusted;
                 const RawKeyboard rawKbd = PackedRawKeyboard{customDraw->nmcd.lItemlParam}.getRawKeyboard();
-                if ((rawKbd.adjustments & flags) != AdjustmentFlags{0})
+                const bool isAdjusted = (rawKbd.adjustments & flags) != AdjustmentFlags{0};
+                const size_t index = customDraw->nmcd.dwItemSpec;
+                const EventMarkers markers = index < keyboardEvents_.size() ? keyboardEvents_.markers[index] : EventMarkers{0};
+                const bool chatters = (markers & EventMarkers::Chatter) != EventMarkers{0};
+                const bool anomalous = (markers & EventMarkers::Anomalies) != EventMarkers{0};
+                if (isAdjusted || chatters || anomalous)
                 {
-                    // Draw adjusted values (VK or scan code) in bold to hint to the user what was adjusted.
-                    const int mask = (rawKbd.adjustments & AdjustmentFlags::VirtualKeyAdjusted) != AdjustmentFlags{0} ? 0b0110 : 0b1000;
-                    SelectObject(customDraw->nmcd.hdc, ((1 << customDraw->iSubItem) & mask) != 0 ? listView_.getBoldFont() : listView_.getFont());
+                    HFONT font = listView_.getFont();
+                    if (isAdjusted)
+                    {
+                        // Draw adjusted values (VK or scan code) in bold to hint to the user what was adjusted.
+                        const int mask = (rawKbd.adjustments & AdjustmentFlags::VirtualKeyAdjusted) != AdjustmentFlags{0} ? 0b0110 : 0b1000;
+                        font = ((1 << customDraw->iSubItem) & mask) != 0 ? listView_.getBoldFont() : font;
+                    }
+                    SelectObject(customDraw->nmcd.hdc, font);
                     customDraw->clrText = GetSysColor(COLOR_INFOTEXT);
-                    customDraw->clrTextBk = GetSysColor(COLOR_INFOBK);
+                    customDraw->clrTextBk = anomalous ? anomalyBackground_ : chatters ? chatterBackground_ : GetSysColor(COLOR_INFOBK);
                     return CDRF_NEWFONT;
                 }
                 return CDRF_DODEFAULT;
@@ -325,60 +559,981 @@ private:
         return false;
     }
 
+    void appendSystemMenuItem(UINT commandId, UINT stringId)
+    {
+        StringResource<64> text(hinstance_, stringId);
+        HMENU systemMenu = GetSystemMenu(hwnd_, FALSE);
+        AppendMenuW(systemMenu, MF_STRING, commandId, text.str());
+    }
+
+    void appendChatterWindowMenu()
+    {
+        // The system menu owns the submenu and destroys it along with the window
+        chatterWindowMenu_ = CreatePopupMenu();
+        StringResource<64> itemFormat(hinstance_, IDS_SYSMENU_CHATTER_WINDOW_ITEM);
+        for (size_t i = 0; i < chatterWindows_.size(); ++i)
+        {
+            const UINT milliseconds = chatterWindows_[i];
+            const std::wstring text = std::vformat(itemFormat.view(), std::make_wformat_args(milliseconds));
+            AppendMenuW(chatterWindowMenu_, MF_STRING, ID_SYSMENU_CHATTER_WINDOW + i * 16, text.c_str());
+        }
+
+        StringResource<64> text(hinstance_, IDS_SYSMENU_CHATTER_WINDOW);
+        AppendMenuW(GetSystemMenu(hwnd_, FALSE), MF_POPUP, reinterpret_cast<UINT_PTR>(chatterWindowMenu_), text.str());
+    }
+
+    // Delays before the event reaches us, as opposed to the ingest latency within our own pipeline. The message time
+    // only has system tick resolution, about 15.6 ms by default, so these are coarse and kept out of the per-event
+    // columns. Input read on capture threads has no message time and isn't included.
+    void appendSourceLatencies(std::wstring& report) const
+    {
+        StringResource<192> format(hinstance_, IDS_REPORT_SOURCE_LATENCY);
+        sourceLatencies_.forEach(
+            [&](uint8_t deviceIndex, const Histogram<>& latencies)
+            {
+                const uintptr_t handle = reinterpret_cast<uintptr_t>(devices_.getHandle(deviceIndex));
+                const uint64_t count = latencies.count();
+                const double mean = latencies.mean() / 1e6;
+                const double p50 = static_cast<double>(latencies.valueAtPercentile(50.0)) / 1e6;
+                const double p99 = static_cast<double>(latencies.valueAtPercentile(99.0)) / 1e6;
+                const double max = static_cast<double>(latencies.max()) / 1e6;
+                report += std::vformat(format.view(), std::make_wformat_args(handle, count, mean, p50, p99, max));
+                report += L'\n';
+            });
+    }
+
+    void appendFlightRecorder(std::wstring& report) const
+    {
+        if (!flightRecorder_)
+        {
+            return;
+        }
+
+        StringResource<256> format(hinstance_, IDS_REPORT_FLIGHT_RECORDER);
+        const FlightRecorder::Status status = flightRecorder_->status();
+        const size_t megabytes = flightRecorder_->capacity() / (1024 * 1024);
+        const uint32_t seconds = flightRecorder_->seconds();
+        report += std::vformat(format.view(), std::make_wformat_args(megabytes, seconds, status.dumps, status.failedDumps, status.ignoredTriggers, status.lostBlocks, status.lastPath));
+        report += L'\n';
+    }
+
+    void appendClock(std::wstring& report) const
+    {
+        StringResource<128> format(hinstance_, PerformanceCounter::isTsc() ? IDS_REPORT_CLOCK_TSC : IDS_REPORT_CLOCK_QPC);
+        const double megahertz = static_cast<double>(PerformanceCounter::frequency()) / 1e6;
+        report += std::vformat(format.view(), std::make_wformat_args(megahertz));
+        report += L'\n';
+    }
+
+    void appendCaptureThreadMenu()
+    {
+        // The system menu owns the submenu and destroys it along with the window
+        captureThreadMenu_ = CreatePopupMenu();
+        StringResource<64> anyCore(hinstance_, IDS_SYSMENU_CAPTURE_ANY_CORE);
+        AppendMenuW(captureThreadMenu_, MF_STRING, ID_SYSMENU_CAPTURE_CORE, anyCore.str());
+        StringResource<64> coreFormat(hinstance_, IDS_SYSMENU_CAPTURE_CORE);
+        for (size_t core = 0; core < getCoreCount(); ++core)
+        {
+            const std::wstring text = std::vformat(coreFormat.view(), std::make_wformat_args(core));
+            AppendMenuW(captureThreadMenu_, MF_STRING, ID_SYSMENU_CAPTURE_CORE + (core + 1) * 16, text.c_str());
+        }
+
+        AppendMenuW(captureThreadMenu_, MF_SEPARATOR, 0, nullptr);
+        StringResource<64> priority(hinstance_, IDS_SYSMENU_CAPTURE_PRIORITY);
+        AppendMenuW(captureThreadMenu_, MF_STRING, ID_SYSMENU_CAPTURE_PRIORITY, priority.str());
+        StringResource<64> busyPoll(hinstance_, IDS_SYSMENU_CAPTURE_BUSY_POLL);
+        AppendMenuW(captureThreadMenu_, MF_STRING, ID_SYSMENU_CAPTURE_BUSY_POLL, busyPoll.str());
+
+        StringResource<64> text(hinstance_, IDS_SYSMENU_CAPTURE_THREAD);
+        AppendMenuW(GetSystemMenu(hwnd_, FALSE), MF_POPUP, reinterpret_cast<UINT_PTR>(captureThreadMenu_), text.str());
+    }
+
+    // Cores a capture thread can be pinned to; affinity masks have a bit per core
+    [[nodiscard]] static size_t getCoreCount() noexcept
+    {
+        return std::clamp<size_t>(std::thread::hardware_concurrency(), 1, maxCaptureCores_);
+    }
+
+    // Running capture threads keep the schedule they were started with
+    void setCaptureSchedule(CaptureSchedule schedule) noexcept
+    {
+        captureSchedule_ = schedule;
+        if (captureSchedule_.core < -1 || captureSchedule_.core >= static_cast<int>(getCoreCount()))
+        {
+            captureSchedule_.core = -1;
+        }
+
+        const UINT last = static_cast<UINT>(ID_SYSMENU_CAPTURE_CORE + getCoreCount() * 16);
+        CheckMenuRadioItem(captureThreadMenu_, ID_SYSMENU_CAPTURE_CORE, last, static_cast<UINT>(ID_SYSMENU_CAPTURE_CORE + (captureSchedule_.core + 1) * 16), MF_BYCOMMAND);
+        CheckMenuItem(captureThreadMenu_, ID_SYSMENU_CAPTURE_PRIORITY, MF_BYCOMMAND | (captureSchedule_.timeCritical ? MF_CHECKED : MF_UNCHECKED));
+        CheckMenuItem(captureThreadMenu_, ID_SYSMENU_CAPTURE_BUSY_POLL, MF_BYCOMMAND | (captureSchedule_.busyPoll ? MF_CHECKED : MF_UNCHECKED));
+    }
+
+    void appendCaptureThreads(std::wstring& report) const
+    {
+        static constexpr std::array<UINT, 2> threadNames{IDS_DEVICE_KEYBOARD, IDS_DEVICE_MOUSE}; // In getRawInputDevices() order
+        StringResource<256> format(hinstance_, IDS_REPORT_CAPTURE_THREAD);
+        StringResource<64> coreFormat(hinstance_, IDS_CAPTURE_CORE);
+        StringResource<64> anyCore(hinstance_, IDS_CAPTURE_ANY_CORE);
+        StringResource<64> timeCritical(hinstance_, IDS_CAPTURE_TIME_CRITICAL);
+        StringResource<64> normalPriority(hinstance_, IDS_CAPTURE_NORMAL_PRIORITY);
+        StringResource<64> busyPoll(hinstance_, IDS_CAPTURE_BUSY_POLL);
+        StringResource<64> waiting(hinstance_, IDS_CAPTURE_WAITING);
+        for (size_t i = 0; i < captureThreads_.size() && i < threadNames.size(); ++i)
+        {
+            const CaptureSchedule& schedule = captureThreads_[i]->schedule();
+            Histogram<> delay;
+            captureThreads_[i]->copySchedulingDelay(delay);
+            StringResource<64> name(hinstance_, threadNames[i]);
+            const std::wstring_view nameView = name.view();
+            const std::wstring core = schedule.core >= 0 ? std::vformat(coreFormat.view(), std::make_wformat_args(schedule.core)) : std::wstring(anyCore.view());
+            const std::wstring_view priority = schedule.timeCritical ? timeCritical.view() : normalPriority.view();
+            const std::wstring_view mode = schedule.busyPoll ? busyPoll.view() : waiting.view();
+            const double p50 = static_cast<double>(delay.valueAtPercentile(50.0)) / 1000.0;
+            const double p99 = static_cast<double>(delay.valueAtPercentile(99.0)) / 1000.0;
+            const double p999 = static_cast<double>(delay.valueAtPercentile(99.9)) / 1000.0;
+            const double max = static_cast<double>(delay.max()) / 1000.0;
+            const uint64_t samples = delay.count();
+            report += std::vformat(format.view(), std::make_wformat_args(nameView, core, priority, mode, p50, p99, p999, max, samples));
+            report += L'\n';
+        }
+    }
+
+    void appendAnomalies(std::wstring& report) const
+    {
+        StringResource<192> format(hinstance_, IDS_REPORT_ANOMALIES);
+        const UINT milliseconds = stuckKeyMilliseconds_;
+        validators_.forEach(
+            [&](uint8_t deviceIndex, const InputValidator& validator)
+            {
+                const uintptr_t handle = reinterpret_cast<uintptr_t>(devices_.getHandle(deviceIndex));
+                const InputValidator::Counts& counts = validator.counts();
+                report += std::vformat(format.view(), std::make_wformat_args(handle, counts.stuckKeys, milliseconds, counts.orphanKeyUps, counts.brokenSequences, counts.virtualKeyMismatches, counts.timeRegressions));
+                report += L'\n';
+            });
+    }
+
+    void appendChatter(std::wstring& report) const
+    {
+        StringResource<128> deviceFormat(hinstance_, IDS_REPORT_CHATTER);
+        StringResource<128> keyFormat(hinstance_, IDS_REPORT_KEY_CHATTER);
+        const UINT milliseconds = chatterWindows_[chatterWindowIndex_];
+        chatterDetectors_.forEach(
+            [&](uint8_t deviceIndex, const ChatterDetector& detector)
+            {
+                const uintptr_t handle = reinterpret_cast<uintptr_t>(devices_.getHandle(deviceIndex));
+                const uint64_t total = detector.total();
+                report += std::vformat(deviceFormat.view(), std::make_wformat_args(handle, total, milliseconds));
+                report += L'\n';
+                for (size_t key = 0; key < ChatterDetector::keyCount; ++key)
+                {
+                    if (const uint32_t count = detector.count(key); count != 0)
+                    {
+                        report += std::vformat(keyFormat.view(), std::make_wformat_args(key, count));
+                        report += L'\n';
+                    }
+                }
+            });
+    }
+
+    void appendDistribution(std::wstring& report, UINT nameId, const Histogram<>& histogram) const
+    {
+        StringResource<64> name(hinstance_, nameId);
+        StringResource<128> format(hinstance_, IDS_REPORT_DISTRIBUTION);
+
+        // Histograms record nanoseconds, the report shows microseconds
+        const std::wstring_view nameView = name.view();
+        const uint64_t count = histogram.count();
+        const double mean = histogram.mean() / 1000.0;
+        const double p50 = static_cast<double>(histogram.valueAtPercentile(50.0)) / 1000.0;
+        const double p99 = static_cast<double>(histogram.valueAtPercentile(99.0)) / 1000.0;
+        const double max = static_cast<double>(histogram.max()) / 1000.0;
+        report += std::vformat(format.view(), std::make_wformat_args(nameView, count, mean, p50, p99, max));
+        report += L'\n';
+    }
+
+    void appendKeyHolds(std::wstring& report) const
+    {
+        uint64_t missingUps = 0;
+        uint64_t duplicateUps = 0;
+        holdTrackers_.forEach(
+            [&](uint8_t, const KeyHoldTracker& tracker)
+            {
+                missingUps += tracker.missingUps();
+                duplicateUps += tracker.duplicateUps();
+            });
+
+        StringResource<128> countersFormat(hinstance_, IDS_REPORT_HOLD_COUNTERS);
+        const uint64_t holds = holdIntervals_.size();
+        report += std::vformat(countersFormat.view(), std::make_wformat_args(holds, missingUps, duplicateUps));
+        report += L'\n';
+        appendDistribution(report, IDS_REPORT_HOLD_DURATIONS, holdDurations_);
+
+        // Holds without a key-up are left out of the per-key distributions
+        StringResource<128> keyFormat(hinstance_, IDS_REPORT_KEY_HOLD);
+        for (size_t key = 0; key < keyHoldDurations_->size(); ++key)
+        {
+            if (const Histogram<>& durations = (*keyHoldDurations_)[key]; durations.count() != 0)
+            {
+                const uint64_t count = durations.count();
+                const double mean = durations.mean() / 1e6;
+                const double p50 = static_cast<double>(durations.valueAtPercentile(50.0)) / 1e6;
+                const double p99 = static_cast<double>(durations.valueAtPercentile(99.0)) / 1e6;
+                report += std::vformat(keyFormat.view(), std::make_wformat_args(key, count, mean, p50, p99));
+                report += L'\n';
+            }
+        }
+    }
+
+    [[nodiscard]] static std::wstring formatKeys(const KeyBitset& keys)
+    {
+        std::wstring text;
+        keys.forEach([&](USHORT lookupCode) { std::format_to(std::back_inserter(text), L"{}{:#05x}", text.empty() ? L"" : L"+", lookupCode); });
+        return text;
+    }
+
+    void appendRollover(std::wstring& report) const
+    {
+        constexpr size_t maxReportedChords = 8;
+        StringResource<128> deviceFormat(hinstance_, IDS_REPORT_ROLLOVER);
+        StringResource<64> chordFormat(hinstance_, IDS_REPORT_CHORD);
+        StringResource<64> blockedFormat(hinstance_, IDS_REPORT_BLOCKED_KEY);
+        rolloverAnalyzers_.forEach(
+            [&](uint8_t deviceIndex, const RolloverAnalyzer& analyzer)
+            {
+                const uintptr_t handle = reinterpret_cast<uintptr_t>(devices_.getHandle(deviceIndex));
+                const size_t maxPressed = analyzer.maxPressed();
+                const uint64_t chords = analyzer.chords().size() + analyzer.droppedChords();
+                const uint64_t blocked = analyzer.blockedKeyCount();
+                report += std::vformat(deviceFormat.view(), std::make_wformat_args(handle, maxPressed, chords, blocked));
+                report += L'\n';
+
+                // The largest chords are the interesting ones for n-key rollover
+                std::vector<const RolloverAnalyzer::Chord*> largest;
+                for (const RolloverAnalyzer::Chord& chord : analyzer.chords())
+                {
+                    largest.push_back(&chord);
+                }
+                std::ranges::sort(largest, std::ranges::greater{}, [](const RolloverAnalyzer::Chord* chord) { return chord->keys.count(); });
+                for (const RolloverAnalyzer::Chord* chord : largest | std::views::take(maxReportedChords))
+                {
+                    const std::wstring keys = formatKeys(chord->keys);
+                    const uint32_t count = chord->count;
+                    report += std::vformat(chordFormat.view(), std::make_wformat_args(keys, count));
+                    report += L'\n';
+                }
+
+                for (const RolloverAnalyzer::BlockedKey& blockedKey : analyzer.blockedKeys())
+                {
+                    const USHORT lookupCode = blockedKey.lookupCode;
+                    const std::wstring held = formatKeys(blockedKey.held);
+                    report += std::vformat(blockedFormat.view(), std::make_wformat_args(lookupCode, held));
+                    report += L'\n';
+                }
+            });
+    }
+
+    void appendPolling(std::wstring& report, UINT nameId, const DeviceTable<PollingEstimator>& estimators) const
+    {
+        StringResource<64> name(hinstance_, nameId);
+        StringResource<192> format(hinstance_, IDS_REPORT_POLLING);
+        estimators.forEach(
+            [&](uint8_t deviceIndex, const PollingEstimator& estimator)
+            {
+                const std::wstring_view nameView = name.view();
+                const uintptr_t handle = reinterpret_cast<uintptr_t>(devices_.getHandle(deviceIndex));
+                const double rate = estimator.rate();
+                const double mean = estimator.meanNanoseconds() / 1000.0;
+                const double deviation = estimator.standardDeviationNanoseconds() / 1000.0;
+                const double p1 = static_cast<double>(estimator.intervals().valueAtPercentile(1.0)) / 1000.0;
+                const double p99 = static_cast<double>(estimator.intervals().valueAtPercentile(99.0)) / 1000.0;
+                const uint64_t outliers = estimator.outliers();
+                const uint64_t bursts = estimator.bursts();
+                const uint64_t longest = estimator.longestBurst();
+                report += std::vformat(format.view(), std::make_wformat_args(nameView, handle, rate, mean, deviation, p1, p99, outliers, bursts, longest));
+                report += L'\n';
+            });
+    }
+
+    void appendMouseAggregates(std::wstring& report) const
+    {
+        StringResource<256> format(hinstance_, IDS_REPORT_MOUSE);
+        for (size_t i = 0; i < devices_.size(); ++i)
+        {
+            const MouseEventStore::Aggregates totals = mouseEvents_.aggregate(static_cast<uint8_t>(i));
+            if (totals.count == 0)
+            {
+                continue;
+            }
+
+            const uintptr_t handle = reinterpret_cast<uintptr_t>(devices_.getHandle(static_cast<uint8_t>(i)));
+            const auto [left, right, middle, button4, button5] = totals.buttonDowns;
+            report += std::vformat(format.view(), std::make_wformat_args(handle, totals.count, totals.x, totals.y, totals.distanceX, totals.distanceY, left, right, middle, button4, button5, totals.wheel, totals.hwheel));
+            report += L'\n';
+            appendMouseMotion(report, static_cast<uint8_t>(i));
+            if (const WheelAnalyzer* wheel = wheels_.find(static_cast<uint8_t>(i)))
+            {
+                appendWheel(report, IDS_WHEEL_VERTICAL, wheel->vertical);
+                appendWheel(report, IDS_WHEEL_HORIZONTAL, wheel->horizontal);
+            }
+        }
+    }
+
+    void appendWheel(std::wstring& report, UINT nameId, const WheelAxis& axis) const
+    {
+        if (axis.events() == 0)
+        {
+            return;
+        }
+
+        StringResource<32> name(hinstance_, nameId);
+        StringResource<256> format(hinstance_, IDS_REPORT_WHEEL);
+        const std::wstring_view nameView = name.view();
+        const uint64_t events = axis.events();
+        const uint64_t notches = axis.notches();
+        const int64_t total = axis.total();
+        const int remainder = axis.remainder();
+        const double fractional = 100.0 * static_cast<double>(axis.fractionalEvents()) / static_cast<double>(events);
+        const int multiplier = axis.resolutionMultiplier();
+        const int smallestStep = axis.smallestStep();
+        const uint64_t reversals = axis.reversals();
+        const double p50 = static_cast<double>(axis.notchIntervals().valueAtPercentile(50.0)) / 1e6;
+        const double p99 = static_cast<double>(axis.notchIntervals().valueAtPercentile(99.0)) / 1e6;
+        report += std::vformat(format.view(), std::make_wformat_args(nameView, events, notches, total, remainder, fractional, multiplier, smallestStep, reversals, p50, p99));
+        report += L'\n';
+    }
+
+    void appendMouseMotion(std::wstring& report, uint8_t deviceIndex) const
+    {
+        MouseMotion* const motion = mouseMotion_.get();
+        motion->reset();
+        MouseMotionAnalyzer::analyze(mouseEvents_, deviceIndex, *motion);
+
+        StringResource<256> motionFormat(hinstance_, IDS_REPORT_MOUSE_MOTION);
+        const double pathLength = motion->pathLength;
+        const uint64_t velocity50 = motion->velocity.valueAtPercentile(50.0);
+        const uint64_t velocity99 = motion->velocity.valueAtPercentile(99.0);
+        const uint64_t acceleration99 = motion->acceleration.valueAtPercentile(99.0);
+        const double axisAligned = motion->longMoves != 0 ? 100.0 * static_cast<double>(motion->axisAligned) / static_cast<double>(motion->longMoves) : 0.0;
+        const auto busiest = std::ranges::max_element(motion->angles);
+        const size_t direction = static_cast<size_t>(busiest - motion->angles.begin());
+        const double directionShare = motion->moves != 0 ? 100.0 * static_cast<double>(*busiest) / static_cast<double>(motion->moves) : 0.0;
+        report += std::vformat(motionFormat.view(), std::make_wformat_args(pathLength, velocity50, velocity99, acceleration99, axisAligned, direction, directionShare));
+        report += L'\n';
+
+        if (const double drag = MouseMotionAnalyzer::lastDragDistance(mouseEvents_, deviceIndex); drag > 0.0)
+        {
+            StringResource<128> calibrationFormat(hinstance_, IDS_REPORT_MOUSE_CALIBRATION);
+            const double countsPerInch = drag * 25.4 / static_cast<double>(calibrationSweepMillimeters_);
+            report += std::vformat(calibrationFormat.view(), std::make_wformat_args(drag, countsPerInch, calibrationSweepMillimeters_));
+            report += L'\n';
+        }
+
+        appendBallistics(report, deviceIndex, motion->pathLength);
+    }
+
+    // Compares the raw counts a game sees with the cursor path under common pointer acceleration curves
+    void appendBallistics(std::wstring& report, uint8_t deviceIndex, double pathCounts) const
+    {
+        // clang-format off
+        const std::array profiles
+        {
+            std::pair{IDS_BALLISTICS_NONE, BallisticsProfile::none()},
+            std::pair{IDS_BALLISTICS_WINDOWS, BallisticsProfile::windowsEnhancePointerPrecision()},
+            std::pair{IDS_BALLISTICS_LIBINPUT, BallisticsProfile::libinputAdaptive()}
+        };
+        // clang-format on
+
+        StringResource<128> format(hinstance_, IDS_REPORT_MOUSE_BALLISTICS);
+        for (const auto& [nameId, profile] : profiles)
+        {
+            StringResource<64> name(hinstance_, nameId);
+            const std::wstring_view nameView = name.view();
+            PointerBallistics ballistics(profile);
+            const PointerBallistics::CursorPath path = ballistics.simulate(mouseEvents_, deviceIndex);
+            const double pixelsPerCount = pathCounts > 0.0 ? path.length / pathCounts : 0.0;
+            report += std::vformat(format.view(), std::make_wformat_args(nameView, path.x, path.y, path.length, pixelsPerCount));
+            report += L'\n';
+        }
+    }
+
+    void appendHid(std::wstring& report) const
+    {
+        StringResource<256> format(hinstance_, IDS_REPORT_HID);
+        StringResource<128> fieldFormat(hinstance_, IDS_REPORT_HID_FIELD);
+        for (size_t d = 0; d < devices_.size(); ++d)
+        {
+            // The extraction plan was compiled when the device was resolved and runs over all of its reports
+            static const DeviceRegistry::Info unresolved;
+            const DeviceRegistry::Info* found = devices_.find(static_cast<uint8_t>(d));
+            const DeviceRegistry::Info& info = found != nullptr ? *found : unresolved;
+            const HidExtractionPlan& plan = info.plan;
+            const std::span<const HidField> fields = plan.fields();
+            std::vector<int32_t> values(fields.size());
+            std::vector<int32_t> minimums(fields.size(), std::numeric_limits<int32_t>::max());
+            std::vector<int32_t> maximums(fields.size(), std::numeric_limits<int32_t>::min());
+            uint64_t reports = 0;
+            for (size_t i = 0; i < hidReports_.size(); ++i)
+            {
+                if (hidReports_.device[i] == d)
+                {
+                    ++reports;
+                    const HidExtractionPlan::Range range = plan.extract(hidReports_.report(i), values);
+                    for (size_t f = range.first; f < range.last; ++f)
+                    {
+                        minimums[f] = std::min(minimums[f], values[f]);
+                        maximums[f] = std::max(maximums[f], values[f]);
+                    }
+                }
+            }
+
+            if (reports == 0)
+            {
+                continue;
+            }
+
+            const uintptr_t handle = reinterpret_cast<uintptr_t>(devices_.getHandle(static_cast<uint8_t>(d)));
+            const DWORD vendorId = info.vendorId;
+            const DWORD productId = info.productId;
+            const USHORT usagePage = info.usagePage;
+            const USHORT usage = info.usage;
+            const size_t fieldCount = fields.size();
+            report += std::vformat(format.view(), std::make_wformat_args(handle, vendorId, productId, usagePage, usage, reports, fieldCount));
+            report += L'\n';
+
+            for (size_t f = 0; f < std::min(fields.size(), maxReportedHidFields_); ++f)
+            {
+                if (minimums[f] > maximums[f])
+                {
+                    continue;
+                }
+
+                const HidField& field = fields[f];
+                report += std::vformat(fieldFormat.view(), std::make_wformat_args(field.usagePage, field.usage, field.reportId, field.bitOffset, field.bitSize, minimums[f], maximums[f], field.logicalMinimum, field.logicalMaximum));
+                report += L'\n';
+            }
+
+            appendGamepadAxes(report, static_cast<uint8_t>(d), plan);
+        }
+    }
+
+    // Decodes the device's axes into fixed-size column batches, so analysis memory doesn't grow with the capture
+    void appendGamepadAxes(std::wstring& report, uint8_t deviceIndex, const HidExtractionPlan& plan) const
+    {
+        static constexpr size_t batchSize = 1024;
+        struct Axis
+        {
+            size_t field;
+            std::unique_ptr<GamepadAxisAnalyzer> analyzer;
+            std::array<int32_t, batchSize> values;
+            std::array<int64_t, batchSize> times;
+            size_t count;
+        };
+
+        const std::span<const HidField> fields = plan.fields();
+        std::vector<Axis> axes;
+        for (size_t f = 0; f < fields.size(); ++f)
+        {
+            if (GamepadAxisAnalyzer::isAxis(fields[f]))
+            {
+                axes.push_back({.field = f, .analyzer = std::make_unique<GamepadAxisAnalyzer>(fields[f]), .count = 0});
+            }
+        }
+
+        if (axes.empty())
+        {
+            return;
+        }
+
+        std::vector<int32_t> values(fields.size());
+        for (size_t i = 0; i < hidReports_.size(); ++i)
+        {
+            if (hidReports_.device[i] != deviceIndex)
+            {
+                continue;
+            }
+
+            const HidExtractionPlan::Range range = plan.extract(hidReports_.report(i), values);
+            for (Axis& axis : axes)
+            {
+                if (axis.field >= range.first && axis.field < range.last)
+                {
+                    axis.values[axis.count] = values[axis.field];
+                    axis.times[axis.count] = hidReports_.time[i];
+                    if (++axis.count == batchSize)
+                    {
+                        axis.analyzer->analyze(axis.values, axis.times);
+                        axis.count = 0;
+                    }
+                }
+            }
+        }
+
+        StringResource<256> format(hinstance_, IDS_REPORT_GAMEPAD_AXIS);
+        for (Axis& axis : axes)
+        {
+            axis.analyzer->analyze(std::span(axis.values).first(axis.count), std::span(axis.times).first(axis.count));
+            const GamepadAxisAnalyzer& analyzer = *axis.analyzer;
+            if (analyzer.count() == 0)
+            {
+                continue;
+            }
+
+            // Offsets, noise and drift are in percent of the half range, i.e. of full deflection
+            const double percent = 100.0 / analyzer.halfRange();
+            const std::wstring_view name = axisNames_[analyzer.field().usage - 0x30];
+            const double distinct = analyzer.distinctValues();
+            const int64_t possible = static_cast<int64_t>(analyzer.field().logicalMaximum) - analyzer.field().logicalMinimum + 1;
+            const double bits = distinct > 1.0 ? std::log2(distinct) : 0.0;
+            const double resting = 100.0 * static_cast<double>(analyzer.restingCount()) / static_cast<double>(analyzer.count());
+            const double offset = analyzer.restingOffset() * percent;
+            const double noise = analyzer.restingNoise() * percent;
+            const double deadzone = static_cast<double>(analyzer.offsets().valueAtPercentile(99.0)) * percent;
+            const uint64_t jitter = analyzer.jitter().valueAtPercentile(99.0);
+            const double drift = analyzer.drift() * percent;
+            const double p50 = static_cast<double>(analyzer.intervals().valueAtPercentile(50.0)) / 1e6;
+            const double p99 = static_cast<double>(analyzer.intervals().valueAtPercentile(99.0)) / 1e6;
+            report += std::vformat(format.view(), std::make_wformat_args(name, distinct, possible, bits, resting, offset, noise, deadzone, jitter, drift, p50, p99));
+            report += L'\n';
+        }
+    }
+
+    void appendDevices(std::wstring& report) const
+    {
+        StringResource<256> format(hinstance_, IDS_REPORT_DEVICE);
+        for (size_t i = 0; i < devices_.size(); ++i)
+        {
+            const DeviceRegistry::Info* info = devices_.find(static_cast<uint8_t>(i));
+            if (info == nullptr)
+            {
+                continue; // Still being resolved
+            }
+
+            StringResource<32> type(hinstance_, info->type == RIM_TYPEKEYBOARD ? IDS_DEVICE_KEYBOARD : (info->type == RIM_TYPEMOUSE ? IDS_DEVICE_MOUSE : IDS_DEVICE_HID));
+            const std::wstring_view typeView = type.view();
+            const std::wstring_view name = info->name;
+            const uintptr_t handle = reinterpret_cast<uintptr_t>(devices_.getHandle(static_cast<uint8_t>(i)));
+            StringResource<32> state(hinstance_, devices_.isConnected(static_cast<uint8_t>(i)) ? IDS_DEVICE_CONNECTED : IDS_DEVICE_DISCONNECTED);
+            const std::wstring_view stateView = state.view();
+            report += std::vformat(format.view(), std::make_wformat_args(i, typeView, handle, info->vendorId, info->productId, info->usagePage, info->usage, name, stateView));
+            report += L'\n';
+        }
+
+        // The most recent changes, in seconds before now
+        const int64_t now = PerformanceCounter::now();
+        StringResource<64> arrivalFormat(hinstance_, IDS_REPORT_DEVICE_ARRIVAL);
+        StringResource<64> removalFormat(hinstance_, IDS_REPORT_DEVICE_REMOVAL);
+        for (size_t i = deviceChanges_.size() - std::min(deviceChanges_.size(), maxReportedDeviceChanges_); i < deviceChanges_.size(); ++i)
+        {
+            const double seconds = static_cast<double>(PerformanceCounter::toNanoseconds(now - deviceChanges_.time[i])) / 1e9;
+            const uint8_t deviceIndex = deviceChanges_.device[i];
+            const uintptr_t handle = reinterpret_cast<uintptr_t>(devices_.getHandle(deviceIndex));
+            const std::wstring_view changeFormat = deviceChanges_.changes[i] == DeviceChange::Arrival ? arrivalFormat.view() : removalFormat.view();
+            report += std::vformat(changeFormat, std::make_wformat_args(seconds, deviceIndex, handle));
+            report += L'\n';
+        }
+    }
+
+    void showStatistics()
+    {
+        normalizeMouseInput();
+        std::wstring report;
+        appendClock(report);
+        appendDevices(report);
+        appendDistribution(report, IDS_REPORT_LATENCY, metrics_.latency());
+        appendSourceLatencies(report);
+        appendDistribution(report, IDS_REPORT_KEYBOARD_INTERVALS, metrics_.intervals(RIM_TYPEKEYBOARD));
+        appendDistribution(report, IDS_REPORT_MOUSE_INTERVALS, metrics_.intervals(RIM_TYPEMOUSE));
+
+        StringResource<256> countersFormat(hinstance_, IDS_REPORT_KEYBOARD_COUNTERS);
+        keyboardCounters_.forEach(
+            [&](uint8_t deviceIndex, const KeyboardEventCounters& counters)
+            {
+                using enum KeyboardEventCounters::Counter;
+                const uint64_t handle = reinterpret_cast<uintptr_t>(devices_.getHandle(deviceIndex));
+                const uint64_t accepted = counters.get(Accepted);
+                const uint64_t overruns = counters.get(Overrun);
+                const uint64_t zeroMakeCodes = counters.get(ZeroMakeCode);
+                const uint64_t prefixes = counters.get(PrefixSwallowed);
+                const uint64_t mapped = counters.get(MakeCodeMapped);
+                const uint64_t adjusted = counters.get(VirtualKeyAdjusted);
+                report += std::vformat(countersFormat.view(), std::make_wformat_args(handle, accepted, overruns, zeroMakeCodes, prefixes, mapped, adjusted));
+                report += L'\n';
+            });
+
+        appendKeyHolds(report);
+        appendChatter(report);
+        appendAnomalies(report);
+        appendRollover(report);
+        appendPolling(report, IDS_DEVICE_KEYBOARD, keyboardPolling_);
+        appendPolling(report, IDS_DEVICE_MOUSE, mousePolling_);
+        appendCaptureThreads(report);
+        appendFlightRecorder(report);
+        appendMouseAggregates(report);
+        appendHid(report);
+
+        StringResource<128> appTitle(hinstance_, IDS_APP_TITLE);
+        MessageBoxW(hwnd_, report.c_str(), appTitle.str(), MB_OK | MB_ICONINFORMATION);
+    }
+
+    // Writes every captured keyboard, mouse, HID and device change event into one CSV file ordered by time
+    void saveTimeline() noexcept
+    {
+        enum Stream : uint32_t
+        {
+            Keyboard,
+            Mouse,
+            Hid,
+            Device,
+            StreamCount
+        };
+
+        normalizeMouseInput();
+        const std::wstring path = makeTempFilePath(std::format(L"RawInputViewer-{}-{}.timeline.csv", GetCurrentProcessId(), GetTickCount64()));
+        StringResource<128> appTitle(hinstance_, IDS_APP_TITLE);
+        try
+        {
+            TimestampMerge merge(StreamCount);
+            const auto pushChunks = [&merge](uint32_t stream, const auto& column)
+            {
+                for (size_t chunk = 0; chunk < column.chunkCount(); ++chunk)
+                {
+                    merge.push(stream, column.chunk(chunk));
+                }
+                merge.close(stream);
+            };
+            pushChunks(Keyboard, keyboardEvents_.time);
+            pushChunks(Mouse, mouseEvents_.time);
+            pushChunks(Hid, hidReports_.time);
+            pushChunks(Device, deviceChanges_.time);
+
+            OutputFile file(path.c_str());
+            std::string text = "time_ms,stream,device,fields\n";
+            std::vector<TimestampMerge::Event> events(4096);
+            std::optional<int64_t> start;
+            size_t total = 0;
+            while (true)
+            {
+                const size_t count = merge.pop(events);
+                if (count == 0)
+                {
+                    break;
+                }
+
+                for (const TimestampMerge::Event& event : std::span(events).first(count))
+                {
+                    const double ms = static_cast<double>(PerformanceCounter::toNanoseconds(event.time - start.value_or(event.time))) / 1e6;
+                    start = start.value_or(event.time);
+                    const size_t i = static_cast<size_t>(event.sequence);
+                    switch (event.source)
+                    {
+                    case Keyboard:
+                        std::format_to(std::back_inserter(text), "{:.3f},keyboard,{},{:#06x},{}\n", ms, keyboardEvents_.device[i], keyboardEvents_.key[i], keyboardEvents_.isDown[i] ? "down" : "up");
+                        break;
+                    case Mouse:
+                        std::format_to(std::back_inserter(text), "{:.3f},mouse,{},{},{},{:#06x},{},{:#06x}\n", ms, mouseEvents_.device[i], mouseEvents_.dx[i], mouseEvents_.dy[i], mouseEvents_.buttonFlags[i], mouseEvents_.buttonData[i], mouseEvents_.flags[i]);
+                        break;
+                    case Hid:
+                        std::format_to(std::back_inserter(text), "{:.3f},hid,{},", ms, hidReports_.device[i]);
+                        for (const uint8_t byte : hidReports_.report(i))
+                        {
+                            std::format_to(std::back_inserter(text), "{:02x}", byte);
+                        }
+                        text += '\n';
+                        break;
+                    case Device:
+                        std::format_to(std::back_inserter(text), "{:.3f},device,{},{}\n", ms, deviceChanges_.device[i], deviceChanges_.changes[i] == DeviceChange::Arrival ? "arrival" : "removal");
+                        break;
+                    }
+                }
+                total += count;
+
+                if (text.size() >= 1 << 20)
+                {
+                    file.write(text);
+                    text.clear();
+                }
+            }
+            file.write(text);
+
+            const uint32_t streams = StreamCount;
+            StringResource<64> saved(hinstance_, IDS_FILE_SAVED);
+            StringResource<128> mergedFormat(hinstance_, IDS_TIMELINE_MERGED);
+            const std::wstring merged = std::vformat(mergedFormat.view(), std::make_wformat_args(total, streams));
+            const std::wstring message = std::format(L"{}\n{}\n\n{}", saved.view(), path, merged);
+            MessageBoxW(hwnd_, message.c_str(), appTitle.str(), MB_OK | MB_ICONINFORMATION);
+        }
+        catch (const std::exception& ex)
+        {
+            StringResource<64> failed(hinstance_, IDS_FILE_SAVE_FAILED);
+            const std::wstring message = std::format(L"{}\n{}\n{}", failed.view(), path, toWString(std::string_view(ex.what())));
+            MessageBoxW(hwnd_, message.c_str(), appTitle.str(), MB_OK | MB_ICONERROR);
+        }
+    }
+
+#ifdef RAWINPUTVIEWER_ENABLE_TRACING
+    void saveTrace() noexcept
+    {
+        const std::wstring path = makeTempFilePath(std::format(L"RawInputViewer-{}-{}.trace.json", GetCurrentProcessId(), GetTickCount64()));
+        StringResource<128> appTitle(hinstance_, IDS_APP_TITLE);
+        try
+        {
+            OutputFile file(path.c_str());
+            Tracer::writeJson(file);
+
+            StringResource<64> saved(hinstance_, IDS_FILE_SAVED);
+            const std::wstring text = std::format(L"{}\n{}", saved.view(), path);
+            MessageBoxW(hwnd_, text.c_str(), appTitle.str(), MB_OK | MB_ICONINFORMATION);
+        }
+        catch (const std::exception& ex)
+        {
+            StringResource<64> failed(hinstance_, IDS_FILE_SAVE_FAILED);
+            const std::wstring text = std::format(L"{}\n{}\n{}", failed.view(), path, toWString(std::string_view(ex.what())));
+            MessageBoxW(hwnd_, text.c_str(), appTitle.str(), MB_OK | MB_ICONERROR);
+        }
+    }
+#endif
+
 #pragma region Window message handling
 
     [[nodiscard]] std::optional<LRESULT> onCreate(HWND, UINT, WPARAM, LPARAM)
     {
         toolBar_.create(hinstance_, *this);
         listView_.create<IDS_COLUMNS>(hinstance_, *this);
+        mouseListView_.create<IDS_MOUSE_COLUMNS>(hinstance_, *this, LVS_OWNERDATA);
+        mouseListView_.setVisible(false);
         statusBar_.create(hinstance_, *this);
+
+        StringResource<128> metricsFormat(hinstance_, IDS_STATUS_BAR_METRICS);
+        metricsFormat_ = metricsFormat.view();
+        lastMetrics_ = metrics_.snapshot();
+        SetTimer(hwnd_, metricsTimerId_, metricsRefreshInterval_, nullptr);
+
+        appendSystemMenuItem(ID_SYSMENU_STATISTICS, IDS_SYSMENU_STATISTICS);
+        appendChatterWindowMenu();
+        appendSystemMenuItem(ID_SYSMENU_MOUSE_EVENTS, IDS_SYSMENU_MOUSE_EVENTS);
+        appendSystemMenuItem(ID_SYSMENU_CAPTURE_HID, IDS_SYSMENU_CAPTURE_HID);
+        appendSystemMenuItem(ID_SYSMENU_THREADED_CAPTURE, IDS_SYSMENU_THREADED_CAPTURE);
+        appendCaptureThreadMenu();
+        setCaptureSchedule({});
+        appendSystemMenuItem(ID_SYSMENU_SAVE_TIMELINE, IDS_SYSMENU_SAVE_TIMELINE);
+        appendSystemMenuItem(ID_SYSMENU_FLIGHT_RECORDER, IDS_SYSMENU_FLIGHT_RECORDER);
+        appendSystemMenuItem(ID_SYSMENU_DUMP_FLIGHT_RECORDER, IDS_SYSMENU_DUMP_FLIGHT_RECORDER);
+        setChatterWindow(defaultChatterWindowIndex_);
+#ifdef RAWINPUTVIEWER_ENABLE_TRACING
+        appendSystemMenuItem(ID_SYSMENU_SAVE_TRACE, IDS_SYSMENU_SAVE_TRACE);
+#endif
+        return 0;
+    }
+
+    [[nodiscard]] std::optional<LRESULT> onInput(HWND, UINT, WPARAM wParam, LPARAM lParam)
+    {
+        TRACE_SCOPE("onInput");
+        COUNT_ALLOCATIONS(HotPathStage::Ingest);
+
+        const int64_t ingestTime = PerformanceCounter::now();
+        UINT size = 0;
+        if (GetRawInputData(reinterpret_cast<HRAWINPUT>(lParam), RID_INPUT, nullptr, &size, sizeof(RAWINPUTHEADER)) == static_cast<UINT>(-1))
+        {
+            THROW_LAST_SYSTEM_ERROR();
+        }
+
+        TempBuffer<void> buffer(size);
+        RAWINPUT* raw = static_cast<RAWINPUT*>(buffer.data());
+
+        if (GetRawInputData(reinterpret_cast<HRAWINPUT>(lParam), RID_INPUT, raw, &size, sizeof(RAWINPUTHEADER)) == static_cast<UINT>(-1))
+        {
+            THROW_LAST_SYSTEM_ERROR();
+        }
+
+        metrics_.countEvent(raw->header.dwType, ingestTime);
+        const uint8_t deviceIndex = getDeviceIndex(raw->header.hDevice);
+
+        // The message time is the closest to a device timestamp raw input has. It comes from the system tick count,
+        // so the delivery latency is only known to the tick interval.
+        const DWORD age = GetTickCount() - static_cast<DWORD>(GetMessageTime());
+        sourceLatencies_[deviceIndex].record(uint64_t{age} * 1'000'000);
+
+        switch (raw->header.dwType)
+        {
+            case RIM_TYPEKEYBOARD:
+            {
+                ingestKeyboard(deviceIndex, raw->data.keyboard, ingestTime);
+                break;
+            }
+            case RIM_TYPEMOUSE:
+            {
+                ingestMouse(deviceIndex, raw->data.mouse, ingestTime);
+                break;
+            }
+            case RIM_TYPEHID:
+            {
+                // A single message can carry several reports of the same size
+                const RAWHID& hid = raw->data.hid;
+                const std::span<const uint8_t> reports(hid.bRawData, size_t{hid.dwSizeHid} * hid.dwCount);
+                for (size_t i = 0; hid.dwSizeHid != 0 && i < hid.dwCount; ++i)
+                {
+                    hidReports_.append(deviceIndex, reports.subspan(i * hid.dwSizeHid, hid.dwSizeHid), ingestTime);
+                    if (flightRecorder_)
+                    {
+                        flightRecorder_->recordHid(ingestTime, deviceIndex, reports.subspan(i * hid.dwSizeHid, hid.dwSizeHid));
+                    }
+                }
+                break;
+            }
+        }
+
+        // Per https://learn.microsoft.com/en-us/windows/win32/inputdev/wm-input,
+        // if inputCode is RIM_INPUT (0), DefWindowProc() must be called for system cleanup.
+        // Returning std::nullopt causes windowSubclassProc() to call DefSubclassProc(),
+        // satisfying this requirement. For RIM_INPUTSINK (1), return 0 as processed.
+        const int inputCode = GET_RAWINPUT_CODE_WPARAM(wParam);
+        return inputCode == RIM_INPUT ? std::nullopt : std::optional<LRESULT>(0);
+    }
+
+    // Input read by the capture threads takes the same path as WM_INPUT from here on
+    [[nodiscard]] std::optional<LRESULT> onCapturedInput(HWND, UINT, WPARAM, LPARAM)
+    {
+        TRACE_SCOPE("onCapturedInput");
+        COUNT_ALLOCATIONS(HotPathStage::Ingest);
+
+        std::array<CapturedInput, 256> events;
+        size_t count = 0;
+        do
+        {
+            count = captureChannel_->pop(events);
+            for (const CapturedInput& event : std::span(events).first(count))
+            {
+                metrics_.countEvent(event.header.dwType, event.time);
+                const uint8_t deviceIndex = getDeviceIndex(event.header.hDevice);
+                if (event.header.dwType == RIM_TYPEKEYBOARD)
+                {
+                    ingestKeyboard(deviceIndex, event.keyboard, event.time);
+                }
+                else
+                {
+                    ingestMouse(deviceIndex, event.mouse, event.time);
+                }
+            }
+        } while (count == events.size());
+
+        metrics_.countDropped(captureChannel_->takeDropped());
         return 0;
     }
 
-    [[nodiscard]] std::optional<LRESULT> onInput(HWND, UINT, WPARAM wParam, LPARAM lParam)
+    // Registers the device; state a removed device left behind under the index it takes over starts over
+    [[nodiscard]] uint8_t getDeviceIndex(HANDLE device)
+    {
+        bool isAssigned = false;
+        const uint8_t deviceIndex = devices_.getIndex(device, isAssigned);
+        if (isAssigned)
+        {
+            keyboardCounters_.reset(deviceIndex);
+            holdTrackers_.reset(deviceIndex);
+            chatterDetectors_.reset(deviceIndex);
+            rolloverAnalyzers_.reset(deviceIndex);
+            validators_.reset(deviceIndex);
+            keyboardPolling_.reset(deviceIndex);
+            mousePolling_.reset(deviceIndex);
+            wheels_.reset(deviceIndex);
+            sourceLatencies_.reset(deviceIndex);
+            forgetMousePosition(deviceIndex);
+        }
+        return deviceIndex;
+    }
+
+    void ingestKeyboard(uint8_t deviceIndex, const RAWKEYBOARD& keyboard, int64_t ingestTime)
+    {
+        RawKeyboard rawKbd(keyboard);
+        keyboardPolling_[deviceIndex].onReport(ingestTime);
+        if (flightRecorder_)
+        {
+            flightRecorder_->recordKeyboard(ingestTime, deviceIndex, keyboard); // As received, before adjustments
+        }
+
+        if (rawKbd.MakeCode == KEYBOARD_OVERRUN_MAKE_CODE)
+        {
+            metrics_.countOverrun();
+        }
+
+        const KeyboardDisposition disposition = toolBar_.isAdjustmentChecked() ? adjustKeyboardInput(rawKbd) : KeyboardDisposition::Accepted;
+        keyboardCounters_[deviceIndex].count(disposition, rawKbd.adjustments);
+
+        if (disposition == KeyboardDisposition::Accepted)
+        {
+            const EventMarkers anomalies = validateKeyboardInput(deviceIndex, rawKbd, ingestTime);
+            trackKeyHold(deviceIndex, rawKbd, ingestTime);
+            rolloverAnalyzers_[deviceIndex].onKey(rawKbd.getLookupCode(), rawKbd.isKeyDown);
+            addKeyEventToListView(deviceIndex, rawKbd, ingestTime, anomalies);
+            metrics_.recordLatency(ingestTime);
+        }
+        else if (disposition == KeyboardDisposition::PrefixSwallowed)
+        {
+            // Prefixes aren't shown but open the sequences the validator checks
+            validateKeyboardInput(deviceIndex, rawKbd, ingestTime);
+        }
+        else
+        {
+            metrics_.countDropped();
+        }
+    }
+
+    void ingestMouse(uint8_t deviceIndex, const RAWMOUSE& mouse, int64_t ingestTime)
     {
-        UINT size = 0;
-        if (GetRawInputData(reinterpret_cast<HRAWINPUT>(lParam), RID_INPUT, nullptr, &size, sizeof(RAWINPUTHEADER)) == static_cast<UINT>(-1))
+        mousePolling_[deviceIndex].onReport(ingestTime);
+        mouseEvents_.append(deviceIndex, mouse, ingestTime);
+        if (flightRecorder_)
         {
-            THROW_LAST_SYSTEM_ERROR();
+            flightRecorder_->recordMouse(ingestTime, deviceIndex, mouse);
         }
+        wheels_[deviceIndex].onMouse(mouse, ingestTime);
 
-        TempBuffer<void> buffer(size);
-        RAWINPUT* raw = static_cast<RAWINPUT*>(buffer.data());
+        // Right-clicks are captured data while the mouse events are shown, and with threaded capture they may come
+        // from other windows
+        if ((mouse.usButtonFlags & RI_MOUSE_RIGHT_BUTTON_UP) != 0 && !mouseListView_.isVisible() && GetForegroundWindow() == hwnd_)
+        {
+            clearListView();
+        }
+    }
 
-        if (GetRawInputData(reinterpret_cast<HRAWINPUT>(lParam), RID_INPUT, raw, &size, sizeof(RAWINPUTHEADER)) == static_cast<UINT>(-1))
+    // Devices come and go without re-registering; a removed keyboard's pressed keys are released, as if the window
+    // had lost the focus, and its per-device state stays until a device arriving later takes over its index
+    [[nodiscard]] std::optional<LRESULT> onInputDeviceChange(HWND, UINT, WPARAM wParam, LPARAM lParam)
+    {
+        const int64_t now = PerformanceCounter::now();
+        const HANDLE device = reinterpret_cast<HANDLE>(lParam);
+        const bool arrived = wParam == GIDC_ARRIVAL;
+        const std::optional<uint8_t> knownIndex = devices_.findIndex(device);
+        if (arrived && knownIndex && devices_.isConnected(*knownIndex))
         {
-            THROW_LAST_SYSTEM_ERROR();
+            return 0; // Registering again repeats the arrival of every attached device
         }
 
-        switch (raw->header.dwType)
+        const uint8_t deviceIndex = knownIndex ? *knownIndex : getDeviceIndex(device);
+        devices_.setConnected(deviceIndex, arrived);
+        deviceChanges_.append(deviceIndex, arrived ? DeviceChange::Arrival : DeviceChange::Removal, now);
+        if (flightRecorder_)
         {
-            case RIM_TYPEKEYBOARD:
-            {
-                RawKeyboard rawKbd(raw->data.keyboard);
+            flightRecorder_->recordDeviceChange(now, deviceIndex, arrived ? DeviceChange::Arrival : DeviceChange::Removal);
+        }
 
-                if (!toolBar_.isAdjustmentChecked() || adjustKeyboardInput(rawKbd))
-                {
-                    addKeyEventToListView(rawKbd);
-                }
-                break;
+        if (!arrived)
+        {
+            if (KeyHoldTracker* tracker = holdTrackers_.find(deviceIndex))
+            {
+                tracker->flush(deviceIndex, now, holdIntervals_);
             }
-            case RIM_TYPEMOUSE:
+            if (RolloverAnalyzer* analyzer = rolloverAnalyzers_.find(deviceIndex))
             {
-                if (raw->data.mouse.usButtonFlags & RI_MOUSE_RIGHT_BUTTON_UP)
-                {
-                    clearListView();
-                }
-                break;
+                analyzer->release();
+            }
+            if (InputValidator* validator = validators_.find(deviceIndex))
+            {
+                validator->release();
             }
+            forgetMousePosition(deviceIndex);
         }
-
-        // Per https://learn.microsoft.com/en-us/windows/win32/inputdev/wm-input,
-        // if inputCode is RIM_INPUT (0), DefWindowProc() must be called for system cleanup.
-        // Returning std::nullopt causes windowSubclassProc() to call DefSubclassProc(),
-        // satisfying this requirement. For RIM_INPUTSINK (1), return 0 as processed.
-        const int inputCode = GET_RAWINPUT_CODE_WPARAM(wParam);
-        return inputCode == RIM_INPUT ? std::nullopt : std::optional<LRESULT>(0);
+        return 0;
     }
 
     [[nodiscard]] std::optional<LRESULT> onSize(HWND, UINT, WPARAM, LPARAM)
@@ -407,6 +1562,135 @@ private:
         return std::nullopt; // Let DefWindowProcW() deal with unhandled messages
     }
 
+    [[nodiscard]] std::optional<LRESULT> onActivate(HWND, UINT, WPARAM wParam, LPARAM)
+    {
+        if (LOWORD(wParam) == WA_INACTIVE)
+        {
+            abandonPressedKeys();
+        }
+
+        return std::nullopt; // Let DefWindowProcW() deal with the activation
+    }
+
+    [[nodiscard]] std::optional<LRESULT> onTimer(HWND, UINT, WPARAM wParam, LPARAM)
+    {
+        if (wParam == metricsTimerId_)
+        {
+            PerformanceCounter::recalibrate();
+            sweepStuckKeys();
+            updateMetrics();
+            updateMouseListView();
+            return 0;
+        }
+
+        return std::nullopt; // Let DefWindowProcW() deal with unhandled messages
+    }
+
+    // Virtual keys depend on the keyboard layout
+    [[nodiscard]] std::optional<LRESULT> onInputLangChange(HWND, UINT, WPARAM, LPARAM lParam)
+    {
+        virtualKeys_.rebuild(reinterpret_cast<HKL>(lParam));
+        return std::nullopt; // Let DefWindowProcW() pass it on to the child windows
+    }
+
+    [[nodiscard]] std::optional<LRESULT> onHotKey(HWND, UINT, WPARAM wParam, LPARAM)
+    {
+        if (wParam == flightRecorderHotKeyId_)
+        {
+            triggerFlightRecorder(FlightRecorder::Trigger::Hotkey);
+            return 0;
+        }
+
+        return std::nullopt; // Let DefWindowProcW() deal with unhandled messages
+    }
+
+    [[nodiscard]] std::optional<LRESULT> onSysCommand(HWND, UINT, WPARAM wParam, LPARAM)
+    {
+        // The four low-order bits of wParam are used internally by the system
+        switch (wParam & 0xfff0)
+        {
+            case ID_SYSMENU_STATISTICS:
+            {
+                showStatistics();
+                return 0;
+            }
+            case ID_SYSMENU_MOUSE_EVENTS:
+            {
+                showMouseListView(!mouseListView_.isVisible());
+                return 0;
+            }
+            case ID_SYSMENU_CAPTURE_HID:
+            {
+                setHidCapture(!captureHid_);
+                registerRawInputDevice();
+                return 0;
+            }
+            case ID_SYSMENU_THREADED_CAPTURE:
+            {
+                setThreadedCapture(!threadedCapture_);
+                registerRawInputDevice();
+                return 0;
+            }
+            case ID_SYSMENU_CAPTURE_PRIORITY:
+            {
+                CaptureSchedule schedule = captureSchedule_;
+                schedule.timeCritical = !schedule.timeCritical;
+                setCaptureSchedule(schedule);
+                registerRawInputDevice();
+                return 0;
+            }
+            case ID_SYSMENU_CAPTURE_BUSY_POLL:
+            {
+                CaptureSchedule schedule = captureSchedule_;
+                schedule.busyPoll = !schedule.busyPoll;
+                setCaptureSchedule(schedule);
+                registerRawInputDevice();
+                return 0;
+            }
+            case ID_SYSMENU_FLIGHT_RECORDER:
+            {
+                setFlightRecorder(!flightRecorder_);
+                return 0;
+            }
+            case ID_SYSMENU_DUMP_FLIGHT_RECORDER:
+            {
+                triggerFlightRecorder(FlightRecorder::Trigger::Manual);
+                return 0;
+            }
+            case ID_SYSMENU_SAVE_TIMELINE:
+            {
+                saveTimeline();
+                return 0;
+            }
+#ifdef RAWINPUTVIEWER_ENABLE_TRACING
+            case ID_SYSMENU_SAVE_TRACE:
+            {
+                saveTrace();
+                return 0;
+            }
+#endif
+            default:
+            {
+                if (const WPARAM command = wParam & 0xfff0; command >= ID_SYSMENU_CHATTER_WINDOW && (command - ID_SYSMENU_CHATTER_WINDOW) / 16 < chatterWindows_.size())
+                {
+                    setChatterWindow((command - ID_SYSMENU_CHATTER_WINDOW) / 16);
+                    return 0;
+                }
+                if (const WPARAM command = wParam & 0xfff0; command >= ID_SYSMENU_CAPTURE_CORE && (command - ID_SYSMENU_CAPTURE_CORE) / 16 <= getCoreCount())
+                {
+                    CaptureSchedule schedule = captureSchedule_;
+                    schedule.core = static_cast<int>((command - ID_SYSMENU_CAPTURE_CORE) / 16) - 1;
+                    setCaptureSchedule(schedule);
+                    registerRawInputDevice();
+                    return 0;
+                }
+                break;
+            }
+        }
+
+        return std::nullopt; // Let DefWindowProcW() deal with unhandled messages
+    }
+
     [[nodiscard]] std::optional<LRESULT> onNotify(HWND, UINT, WPARAM, LPARAM lParam)
     {
         if (auto hdr = reinterpret_cast<const NMHDR*>(lParam); listView_.isSame(hdr->hwndFrom))
@@ -434,6 +1718,20 @@ private:
                 }
             }
         }
+        else if (mouseListView_.isSame(hdr->hwndFrom))
+        {
+            switch (hdr->code)
+            {
+                case LVN_GETDISPINFO:
+                {
+                    return getMouseListViewItemDisplayInfo(reinterpret_cast<NMLVDISPINFOW*>(lParam)->item);
+                }
+                case LVN_ITEMCHANGING:
+                {
+                    return TRUE; // Prevent selection change
+                }
+            }
+        }
         else if (listView_.isHeader(hdr->hwndFrom) && hdr->code == HDN_DROPDOWN)
         {
             auto header = reinterpret_cast<const NMHEADERW*>(lParam);
@@ -470,6 +1768,16 @@ private:
             states |= statusBar_.isNoHotkeysChecked() ? ToolBarButtonStates::NoHotkeys : ToolBarButtonStates{0};
             states |= statusBar_.isNoLegacyChecked() ? ToolBarButtonStates::NoLegacy : ToolBarButtonStates{0};
             regKey.writeBinaryValue(toolBarButtonStates_, states);
+            regKey.writeBinaryValue(chatterWindowValueName_, static_cast<uint32_t>(chatterWindowIndex_));
+            regKey.writeBinaryValue(calibrationSweepValueName_, calibrationSweepMillimeters_);
+            regKey.writeBinaryValue(stuckKeyValueName_, stuckKeyMilliseconds_);
+            regKey.writeBinaryValue(captureHidValueName_, uint32_t{captureHid_});
+            regKey.writeBinaryValue(threadedCaptureValueName_, uint32_t{threadedCapture_});
+            regKey.writeBinaryValue(captureScheduleValueName_, captureSchedule_);
+            regKey.writeBinaryValue(flightRecorderValueName_, uint32_t{flightRecorder_ != nullptr});
+            regKey.writeBinaryValue(flightRecorderMegabytesValueName_, flightRecorderMegabytes_);
+            regKey.writeBinaryValue(flightRecorderSecondsValueName_, flightRecorderSeconds_);
+            regKey.writeBinaryValue(hidUsagesValueName_, hidUsages_);
         }
 
         return std::nullopt; // DefWindowProcW() closes the window and issues a WM_DESTROY message
@@ -477,7 +1785,13 @@ private:
 
     [[nodiscard]] std::optional<LRESULT> onDestroy(HWND, UINT, WPARAM, LPARAM)
     {
+        KillTimer(hwnd_, metricsTimerId_);
+        setFlightRecorder(false);
+        captureThreads_.clear();
         registerRawInputDevice(RIDEV_REMOVE);
+#ifdef RAWINPUTVIEWER_COUNT_ALLOCATIONS
+        AllocationCounter::report();
+#endif
         PostQuitMessage(0);
         return 0;
     }
@@ -498,6 +1812,14 @@ private:
             {
                 return onInput(hwnd, msg, wParam, lParam);
             }
+            case WM_INPUT_DEVICE_CHANGE:
+            {
+                return onInputDeviceChange(hwnd, msg, wParam, lParam);
+            }
+            case capturedInputMessage_:
+            {
+                return onCapturedInput(hwnd, msg, wParam, lParam);
+            }
             case WM_COMMAND:
             {
                 return onCommand(hwnd, msg, wParam, lParam);
@@ -506,6 +1828,31 @@ private:
             {
                 return onNotify(hwnd, msg, wParam, lParam);
             }
+            case WM_SYSCOMMAND:
+            {
+                return onSysCommand(hwnd, msg, wParam, lParam);
+            }
+            case WM_TIMER:
+            {
+                return onTimer(hwnd, msg, wParam, lParam);
+            }
+            case WM_HOTKEY:
+            {
+                return onHotKey(hwnd, msg, wParam, lParam);
+            }
+            case WM_INPUTLANGCHANGE:
+            {
+                return onInputLangChange(hwnd, msg, wParam, lParam);
+            }
+            case flightRecorderTriggerMessage_:
+            {
+                triggerFlightRecorder(FlightRecorder::Trigger::External);
+                return 0;
+            }
+            case WM_ACTIVATE:
+            {
+                return onActivate(hwnd, msg, wParam, lParam);
+            }
             case WM_CLOSE:
             {
                 return onClose(hwnd, msg, wParam, lParam);
@@ -644,10 +1991,10 @@ private:
         }
 
         template<UINT COLUMN_DESC_ID, wchar_t TOKEN_SEP = L';', wchar_t GROUP_SEP = L'|'>
-        void create(HINSTANCE hinstance, const Window& parent)
+        void create(HINSTANCE hinstance, const Window& parent, DWORD extraStyle = 0)
         {
             const SIZE clientSize = parent.getClientSize();
-            const DWORD style = WS_CHILD | WS_VISIBLE | LVS_REPORT;
+            const DWORD style = WS_CHILD | WS_VISIBLE | LVS_REPORT | extraStyle;
             createEx(0, WC_LISTVIEWW, L"", style, 0, 0, clientSize.cx, clientSize.cy, parent.hwnd(), nullptr, hinstance, nullptr);
             setWindowSubclass(hwnd_, this);
             hwndHeader_ = ListView_GetHeader(hwnd_);
@@ -687,6 +2034,7 @@ private:
 
         int insertItem(int position, const RawKeyboard& rawKbd)
         {
+            TRACE_SCOPE("ListView::insertItem");
             _ASSERT(IsWindow(hwnd_));
 
             // clang-format off
@@ -749,6 +2097,13 @@ private:
             ListView_DeleteAllItems(hwnd_);
         }
 
+        // For virtual list views (LVS_OWNERDATA) only
+        void setItemCount(int count) noexcept
+        {
+            _ASSERT(IsWindow(hwnd_));
+            ListView_SetItemCountEx(hwnd_, count, LVSICF_NOINVALIDATEALL | LVSICF_NOSCROLL);
+        }
+
         [[nodiscard]] bool isHeader(HWND hwnd) const noexcept
         {
             if (IsWindow(hwnd) && IsWindow(hwndHeader_))
@@ -906,6 +2261,21 @@ private:
             setWindowSubclass(hwnd_, this);
 
             toolBar_.create(hinstance, *this);
+
+            // The help text part is sized to fit its text, the metrics part takes the remaining space up to the toolbar
+            HDC hdc = GetDC(hwnd_);
+            SelectObject(hdc, reinterpret_cast<HFONT>(sendMessage(WM_GETFONT, 0, 0)));
+            SIZE extent{};
+            GetTextExtentPoint32W(hdc, help.str(), static_cast<int>(help.length()), &extent);
+            ReleaseDC(hwnd_, hdc);
+            helpTextWidth_ = static_cast<int>(extent.cx);
+
+            sendMessage(SB_SETTEXTW, 0 | SBT_NOBORDERS, reinterpret_cast<LPARAM>(help.str()));
+        }
+
+        void setMetricsText(const wchar_t* text) noexcept
+        {
+            sendMessage(SB_SETTEXTW, metricsPart_ | SBT_NOBORDERS, reinterpret_cast<LPARAM>(text));
         }
 
         bool isNoHotkeysChecked() const noexcept
@@ -1015,6 +2385,9 @@ private:
             ImageList imageList_;
         } toolBar_;
 
+        static constexpr WPARAM metricsPart_ = 1;
+        int helpTextWidth_{};
+
         [[nodiscard]] std::optional<LRESULT> dispatchMessage(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) override
         {
             switch (msg)
@@ -1042,6 +2415,9 @@ private:
                     const SIZE tbArea{toolBar_.getButtonAreaSize()};
                     const int left = size.cx - tbArea.cx - size.cy / 2;
                     toolBar_.move(left, (size.cy - tbArea.cy) / 2 + 1, tbArea.cx, tbArea.cy, TRUE);
+
+                    const int parts[] = {std::min<int>(helpTextWidth_ + size.cy, left / 2), left, -1};
+                    sendMessage(SB_SETPARTS, std::size(parts), reinterpret_cast<LPARAM>(parts));
                     break;
                 }
                 case WM_COMMAND:
@@ -1192,11 +2568,11 @@ private:
 
 #pragma endregion
 
-    bool registerRawInputDevice(DWORD flags) noexcept
+    [[nodiscard]] std::array<RAWINPUTDEVICE, 2> getRawInputDevices(DWORD flags) const noexcept
     {
         // clang-format off
-        const RAWINPUTDEVICE rid[]
-        {
+        return
+        {{
             {
                 .usUsagePage = 0x01,
                 .usUsage = 0x06,     // Keyboard
@@ -1206,37 +2582,207 @@ private:
             {
                 .usUsagePage = 0x01,
                 .usUsage = 0x02,     // Mouse
-                .dwFlags = 0,
+                .dwFlags = flags & RIDEV_DEVNOTIFY,
                 .hwndTarget = hwnd_
             }
-        };
+        }};
         // clang-format on
-        return RegisterRawInputDevices(rid, std::size(rid), sizeof(RAWINPUTDEVICE));
     }
 
+    bool registerRawInputDevice(DWORD flags) noexcept
+    {
+        const std::array<RAWINPUTDEVICE, 2> rid = getRawInputDevices(flags);
+        return RegisterRawInputDevices(rid.data(), static_cast<UINT>(rid.size()), sizeof(RAWINPUTDEVICE));
+    }
+
+    // RIDEV_DEVNOTIFY delivers WM_INPUT_DEVICE_CHANGE for devices already attached, too
     bool registerRawInputDevice() noexcept
     {
         DWORD flags = statusBar_.isNoHotkeysChecked() ? 0 : RIDEV_NOHOTKEYS;
         flags |= statusBar_.isNoHotkeysChecked() ? 0 : RIDEV_NOLEGACY;
-        return registerRawInputDevice(flags);
+
+        captureThreads_.clear();
+        if (threadedCapture_ && !startCaptureThreads(flags))
+        {
+            setThreadedCapture(false); // Fall back to WM_INPUT on the window
+        }
+
+        if (!threadedCapture_ && !registerRawInputDevice(flags | RIDEV_DEVNOTIFY))
+        {
+            return false;
+        }
+        return !captureHid_ || registerHidUsages(RIDEV_DEVNOTIFY);
+    }
+
+    // Raw input for a usage goes to a single window, so keyboards and mice get a capture thread each
+    bool startCaptureThreads(DWORD flags) noexcept
+    {
+        try
+        {
+            if (!captureChannel_)
+            {
+                captureChannel_ = std::make_unique<CaptureChannel>(hwnd_, capturedInputMessage_);
+            }
+
+            for (const RAWINPUTDEVICE& device : getRawInputDevices(flags))
+            {
+                captureThreads_.push_back(std::make_unique<RawInputCaptureThread>(*captureChannel_, std::span(&device, 1), hwnd_, captureSchedule_));
+            }
+            return true;
+        }
+        catch (const std::exception&)
+        {
+            captureThreads_.clear();
+            return false;
+        }
+    }
+
+    // The recorder's memory is allocated here, once, for as long as it runs
+    void setFlightRecorder(bool enable) noexcept
+    {
+        if (enable && !flightRecorder_)
+        {
+            try
+            {
+                flightRecorder_ = std::make_unique<FlightRecorder>(flightRecorderMegabytes_, flightRecorderSeconds_, hwnd_, flightRecorderTriggerMessage_);
+                RegisterHotKey(hwnd_, flightRecorderHotKeyId_, MOD_CONTROL | MOD_ALT | MOD_NOREPEAT, VK_PAUSE);
+            }
+            catch (const std::exception&)
+            {
+                enable = false;
+            }
+        }
+        else if (!enable && flightRecorder_)
+        {
+            UnregisterHotKey(hwnd_, flightRecorderHotKeyId_);
+            flightRecorder_.reset();
+        }
+        CheckMenuItem(GetSystemMenu(hwnd_, FALSE), ID_SYSMENU_FLIGHT_RECORDER, MF_BYCOMMAND | (enable ? MF_CHECKED : MF_UNCHECKED));
+    }
+
+    void triggerFlightRecorder(FlightRecorder::Trigger reason) noexcept
+    {
+        if (flightRecorder_)
+        {
+            flightRecorder_->trigger(PerformanceCounter::now(), reason);
+        }
+    }
+
+    void setThreadedCapture(bool threaded) noexcept
+    {
+        threadedCapture_ = threaded;
+        CheckMenuItem(GetSystemMenu(hwnd_, FALSE), ID_SYSMENU_THREADED_CAPTURE, MF_BYCOMMAND | (threaded ? MF_CHECKED : MF_UNCHECKED));
+    }
+
+    bool registerHidUsages(DWORD flags) noexcept
+    {
+        std::array<RAWINPUTDEVICE, maxHidUsages_> rid{};
+        const size_t count = std::min(hidUsages_.size(), rid.size());
+        for (size_t i = 0; i < count; ++i)
+        {
+            // clang-format off
+            rid[i] =
+            {
+                .usUsagePage = HIWORD(hidUsages_[i]),
+                .usUsage = LOWORD(hidUsages_[i]),
+                .dwFlags = flags,
+                .hwndTarget = (flags & RIDEV_REMOVE) != 0 ? nullptr : hwnd_
+            };
+            // clang-format on
+        }
+        return count == 0 || RegisterRawInputDevices(rid.data(), static_cast<UINT>(count), sizeof(RAWINPUTDEVICE));
+    }
+
+    void setHidCapture(bool capture) noexcept
+    {
+        if (captureHid_ && !capture)
+        {
+            registerHidUsages(RIDEV_REMOVE);
+        }
+        captureHid_ = capture;
+        CheckMenuItem(GetSystemMenu(hwnd_, FALSE), ID_SYSMENU_CAPTURE_HID, MF_BYCOMMAND | (capture ? MF_CHECKED : MF_UNCHECKED));
     }
 
     ToolBar toolBar_;
     ListView listView_;
+    ListView mouseListView_;
     StatusBar statusBar_;
     const HINSTANCE hinstance_;
     const std::wstring registryKeyPath_;
     std::map<USHORT, KeyCodes> scanCodeMapping_;
     ScanCodeSequence pendingSequence_{ScanCodeSequence::None};
     std::map<USHORT, std::pair<std::wstring, std::wstring>> vkeyMapping_;
+    InputMetrics metrics_;
+    DeviceTable<KeyboardEventCounters> keyboardCounters_;
+    DeviceTable<KeyHoldTracker> holdTrackers_;
+    HoldIntervalStore holdIntervals_;
+    Histogram<> holdDurations_;
+    // Nanoseconds, by lookup code. Allocated up front, so a key's first hold doesn't allocate on the hot path
+    std::unique_ptr<std::array<Histogram<>, KeyHoldTracker::keyCount>> keyHoldDurations_ = std::make_unique<std::array<Histogram<>, KeyHoldTracker::keyCount>>();
+    KeyboardEventStore keyboardEvents_;
+    DeviceTable<ChatterDetector> chatterDetectors_;
+    DeviceTable<RolloverAnalyzer> rolloverAnalyzers_;
+    DeviceTable<InputValidator> validators_;
+    VirtualKeyTable virtualKeys_;
+    uint32_t stuckKeyMilliseconds_{10'000};
+    DeviceTable<PollingEstimator> keyboardPolling_;
+    DeviceTable<PollingEstimator> mousePolling_;
+    DeviceTable<WheelAnalyzer> wheels_;
+    DeviceTable<Histogram<>> sourceLatencies_; // Nanoseconds from the message time to ingestion
+    AbsoluteMouseNormalizer absoluteMouse_;
+    DeviceRegistry devices_;
+    DeviceChangeStore deviceChanges_;
+    static constexpr size_t maxReportedDeviceChanges_ = 32;
+    MouseEventStore mouseEvents_;
+    std::unique_ptr<MouseMotion> mouseMotion_ = std::make_unique<MouseMotion>(); // Reused by the reports
+    HidReportStore hidReports_;
+    bool captureHid_{};
+    bool threadedCapture_{};
+    std::unique_ptr<CaptureChannel> captureChannel_;
+    std::vector<std::unique_ptr<RawInputCaptureThread>> captureThreads_; // After the channel they push into
+    static constexpr UINT capturedInputMessage_ = WM_APP;
+    CaptureSchedule captureSchedule_;
+    std::unique_ptr<FlightRecorder> flightRecorder_;
+    uint32_t flightRecorderMegabytes_{64};
+    uint32_t flightRecorderSeconds_{30};
+    static constexpr UINT flightRecorderTriggerMessage_ = WM_APP + 1;
+    static constexpr int flightRecorderHotKeyId_ = 1; // Ctrl+Alt+Pause
+    HMENU captureThreadMenu_{};
+    static constexpr size_t maxCaptureCores_ = 64;
+    std::vector<uint32_t> hidUsages_{0x0001'0004, 0x0001'0005, 0x000c'0001}; // Usage page << 16 | usage: joysticks, gamepads, consumer controls
+    static constexpr size_t maxHidUsages_ = 16;
+    static constexpr size_t maxReportedHidFields_ = 32;
+    static constexpr std::array<std::wstring_view, 8> axisNames_{L"X", L"Y", L"Z", L"Rx", L"Ry", L"Rz", L"Slider", L"Dial"}; // HID usages 0x30..0x37
+    uint32_t calibrationSweepMillimeters_{100}; // Length of the sweep the last left-button drag is calibrated against
+    size_t chatterWindowIndex_{defaultChatterWindowIndex_};
+    HMENU chatterWindowMenu_{};
+    static constexpr std::array<UINT, 5> chatterWindows_{2, 5, 10, 20, 50}; // Milliseconds
+    static constexpr size_t defaultChatterWindowIndex_ = 1;
+    static constexpr COLORREF chatterBackground_ = RGB(0xff, 0xd0, 0xd0);
+    static constexpr COLORREF anomalyBackground_ = RGB(0xff, 0xe8, 0xa0);
+    InputMetrics::Snapshot lastMetrics_{};
+    std::wstring metricsFormat_;
+    static constexpr UINT_PTR metricsTimerId_ = 1;
+    static constexpr UINT metricsRefreshInterval_ = 500;
     static constexpr wchar_t toolBarButtonStates_[] = L"ToolbarButtonStates";
     static constexpr wchar_t windowPlacementValueName_[] = L"WindowPlacement";
     static constexpr wchar_t headerPropertiesValueName_[] = L"HeaderProperties";
+    static constexpr wchar_t chatterWindowValueName_[] = L"ChatterWindow";
+    static constexpr wchar_t calibrationSweepValueName_[] = L"CalibrationSweepMillimeters";
+    static constexpr wchar_t stuckKeyValueName_[] = L"StuckKeyMilliseconds";
+    static constexpr wchar_t captureHidValueName_[] = L"CaptureHid";
+    static constexpr wchar_t threadedCaptureValueName_[] = L"ThreadedCapture";
+    static constexpr wchar_t captureScheduleValueName_[] = L"CaptureSchedule";
+    static constexpr wchar_t flightRecorderValueName_[] = L"FlightRecorder";
+    static constexpr wchar_t flightRecorderMegabytesValueName_[] = L"FlightRecorderMegabytes";
+    static constexpr wchar_t flightRecorderSecondsValueName_[] = L"FlightRecorderSeconds";
+    static constexpr wchar_t hidUsagesValueName_[] = L"HidUsages";
 
 public:
     MainWindow(HINSTANCE hinstance, int showCmd)
         : toolBar_{hinstance}
         , listView_{hinstance}
+        , mouseListView_{hinstance}
         , statusBar_{hinstance}
         , hinstance_{hinstance}
         , registryKeyPath_{constructRegistryKeyPath(hinstance)}
@@ -1298,6 +2844,19 @@ public:
             toolBar_.setAdjustmentChecked((states & ToolBarButtonStates::Adjustment) != ToolBarButtonStates{0});
             statusBar_.setNoHotkeysChecked((states & ToolBarButtonStates::NoHotkeys) != ToolBarButtonStates{0});
             statusBar_.setNoLegacyChecked((states & ToolBarButtonStates::NoLegacy) != ToolBarButtonStates{0});
+            setChatterWindow(regKey.readBinaryValue(chatterWindowValueName_, static_cast<uint32_t>(defaultChatterWindowIndex_)));
+            calibrationSweepMillimeters_ = std::max(regKey.readBinaryValue(calibrationSweepValueName_, calibrationSweepMillimeters_), 1u);
+            stuckKeyMilliseconds_ = std::max(regKey.readBinaryValue(stuckKeyValueName_, stuckKeyMilliseconds_), 1u);
+            hidUsages_ = regKey.readBinaryValue(hidUsagesValueName_, hidUsages_);
+            setHidCapture(regKey.readBinaryValue(captureHidValueName_, uint32_t{0}) != 0);
+            setThreadedCapture(regKey.readBinaryValue(threadedCaptureValueName_, uint32_t{0}) != 0);
+            // Time-critical busy polling takes over a core, so it's only ever turned on from the menu
+            CaptureSchedule schedule = regKey.readBinaryValue(captureScheduleValueName_, CaptureSchedule{});
+            schedule.timeCritical = schedule.timeCritical && !schedule.busyPoll;
+            setCaptureSchedule(schedule);
+            flightRecorderMegabytes_ = std::clamp(regKey.readBinaryValue(flightRecorderMegabytesValueName_, flightRecorderMegabytes_), 1u, 4096u);
+            flightRecorderSeconds_ = std::max(regKey.readBinaryValue(flightRecorderSecondsValueName_, flightRecorderSeconds_), 1u);
+            setFlightRecorder(regKey.readBinaryValue(flightRecorderValueName_, uint32_t{0}) != 0);
         }
 
         const std::string scanCodeMapping = loadText(hinstance_, ID_SCANCODE_MAPPING);
@@ -1330,11 +2889,89 @@ public:
 
 END_ANONYMOUS_NAMESPACE
 
+#ifdef RAWINPUTVIEWER_COUNT_ALLOCATIONS
+
+// Replacements for the global allocation functions, counting every allocation made through
+// operator new. The nothrow variants are not replaced since their default implementations
+// forward to the throwing ones.
+void* operator new(size_t size)
+{
+    AllocationCounter::countAllocation();
+    if (void* p = std::malloc(size != 0 ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    AllocationCounter::countAllocation();
+    if (void* p = _aligned_malloc(size != 0 ? size : 1, static_cast<size_t>(alignment)))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    _aligned_free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+    _aligned_free(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept
+{
+    _aligned_free(p);
+}
+
+void operator delete[](void* p, size_t, std::align_val_t) noexcept
+{
+    _aligned_free(p);
+}
+
+#endif // RAWINPUTVIEWER_COUNT_ALLOCATIONS
+
 int WINAPI wWinMain(_In_ HINSTANCE hinstance, _In_opt_ HINSTANCE, _In_ LPWSTR, _In_ int showCmd)
 {
     try
     {
-        MainWindow mainWindow(hinstance, showCmd);
+        // The per-device analyzer tables are too large for the stack
+        const auto mainWindow = std::make_unique<MainWindow>(hinstance, showCmd);
 
         for (Msg msg; msg.getMessage();)
         {
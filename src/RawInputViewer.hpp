@@ -24,12 +24,38 @@
 #include <windowsx.h>
 #include <commctrl.h>
 #include <strsafe.h>
-
+#include <hidsdi.h>
+#include <emmintrin.h>
+#include <intrin.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <bitset>
+#include <condition_variable>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <cwchar>
+#include <deque>
 #include <format>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numbers>
+#include <numeric>
 #include <optional>
 #include <ranges>
+#include <span>
+#include <thread>
+#include <tuple>
+#include <utility>
 #include <vector>
 
+#include "RawInputViewerCore.hpp"
+
 // clang-format off
 #define BEGIN_ANONYMOUS_NAMESPACE namespace {
 #define END_ANONYMOUS_NAMESPACE }
@@ -38,6 +64,9 @@
 #define STRINGIZE_DETAIL(s) #s
 #define STRINGIZE(s) STRINGIZE_DETAIL(s)
 
+#define CONCATENATE_DETAIL(a, b) a##b
+#define CONCATENATE(a, b) CONCATENATE_DETAIL(a, b)
+
 #ifdef _DEBUG
 
 #define FORMATED_FILE_AND_LINE __FILE__ "(" STRINGIZE(__LINE__) ")"
@@ -124,6 +153,13 @@ constexpr auto operator&(const T lhs, const T rhs)
     return static_cast<T>(std::to_underlying(lhs) & std::to_underlying(rhs));
 }
 
+template<typename T>
+    requires(std::is_enum_v<T> && requires(T e) { enableBitmaskOperatorNot(e); })
+constexpr auto operator~(const T value)
+{
+    return static_cast<T>(~std::to_underlying(value));
+}
+
 template<concepts::CharOrWChar CharType = char>
 [[nodiscard]] constexpr bool isWhitespace(CharType ch) noexcept
 {
@@ -550,6 +586,65 @@ private:
     HKEY hkey_{};
 };
 
+class OutputFile
+{
+public:
+    OutputFile(const OutputFile&) = delete;
+    OutputFile& operator=(const OutputFile&) = delete;
+
+    explicit OutputFile(const wchar_t* path)
+        : handle_{CreateFileW(path, GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr)}
+    {
+        if (handle_ == INVALID_HANDLE_VALUE)
+        {
+            THROW_LAST_SYSTEM_ERROR();
+        }
+    }
+
+    void write(const void* data, size_t size)
+    {
+        auto bytes = static_cast<const BYTE*>(data);
+        while (size > 0)
+        {
+            DWORD written = 0;
+            const DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, std::numeric_limits<DWORD>::max()));
+            if (!WriteFile(handle_, bytes, chunk, &written, nullptr))
+            {
+                THROW_LAST_SYSTEM_ERROR();
+            }
+            bytes += written;
+            size -= written;
+        }
+    }
+
+    template<std::ranges::contiguous_range R>
+    void write(R&& range)
+    {
+        write(std::ranges::data(range), std::ranges::size(range) * sizeof(std::ranges::range_value_t<R>));
+    }
+
+    ~OutputFile()
+    {
+        CloseHandle(handle_);
+    }
+
+private:
+    HANDLE handle_;
+};
+
+// Returns "<temp path>\<fileName>"; returns an empty string if the temp path can't be determined
+[[nodiscard]] inline std::wstring makeTempFilePath(std::wstring_view fileName)
+{
+    TempBuffer<wchar_t, MAX_PATH + 1> tempPath(MAX_PATH + 1);
+    const DWORD length = GetTempPathW(static_cast<DWORD>(tempPath.elements()), tempPath.data());
+    if (length == 0 || length > tempPath.elements())
+    {
+        return {};
+    }
+
+    return std::format(L"{}{}", std::wstring_view(tempPath.data(), length), fileName);
+}
+
 class PopupMenu
 {
 public:
@@ -744,6 +839,17 @@ public:
         return MoveWindow(hwnd_, x, y, width, height, repaint);
     }
 
+    void setVisible(bool visible) noexcept
+    {
+        _ASSERT(IsWindow(hwnd_));
+        ShowWindow(hwnd_, visible ? SW_SHOW : SW_HIDE);
+    }
+
+    [[nodiscard]] bool isVisible() const noexcept
+    {
+        return IsWindowVisible(hwnd_);
+    }
+
     [[nodiscard]] bool isSame(HWND hwnd) const noexcept
     {
         if (IsWindow(hwnd) && IsWindow(hwnd_))
@@ -827,6 +933,32 @@ constexpr bool enableBitmaskOperatorOr(AdjustmentFlags);
 constexpr AdjustmentFlags enableBitmaskOperatorOrAssign(AdjustmentFlags);
 constexpr bool enableBitmaskOperatorAnd(AdjustmentFlags);
 
+// Outcome of adjusting a keyboard event; everything but Accepted means the event is not displayed
+enum class KeyboardDisposition : uint32_t
+{
+    Accepted,
+    Overrun,
+    PrefixSwallowed,
+    ZeroMakeCode
+};
+
+// Analyzer findings attached to a stored keyboard event, see KeyboardEventStore
+enum class EventMarkers : uint8_t
+{
+    Chatter = 0b0000'0001,
+    StuckKey = 0b0000'0010,
+    OrphanKeyUp = 0b0000'0100,
+    BrokenSequence = 0b0000'1000,
+    VirtualKeyMismatch = 0b0001'0000,
+    TimeRegression = 0b0010'0000,
+    Anomalies = 0b0011'1110 // Everything InputValidator reports
+};
+
+constexpr bool enableBitmaskOperatorOr(EventMarkers);
+constexpr EventMarkers enableBitmaskOperatorOrAssign(EventMarkers);
+constexpr bool enableBitmaskOperatorAnd(EventMarkers);
+constexpr bool enableBitmaskOperatorNot(EventMarkers);
+
 enum class ToolBarButtonStates : uint32_t
 {
     Adjustment = 0b0001,
@@ -953,3 +1085,3992 @@ struct ToolTipPair
     int buttonId;
     int toolTipId;
 };
+
+// Timestamps are kept in ticks and only converted to time when shown or exported. Where the CPU has an invariant TSC,
+// which ticks at a constant rate on all cores regardless of power states, a tick read is a single RDTSC instead of a
+// QueryPerformanceCounter() call. TscCalibration measures the TSC frequency against QueryPerformanceCounter() at
+// startup and again over the whole time since with each recalibrate(). Without an invariant TSC, or with one whose
+// startup measurements disagree, ticks are QueryPerformanceCounter() ticks.
+class PerformanceCounter
+{
+public:
+    [[nodiscard]] static int64_t now() noexcept
+    {
+        return useTsc_ ? static_cast<int64_t>(__rdtsc()) : Clock::readCounter();
+    }
+
+    [[nodiscard]] static int64_t frequency() noexcept
+    {
+        return calibration().frequency();
+    }
+
+    [[nodiscard]] static uint64_t toNanoseconds(int64_t ticks) noexcept
+    {
+        return ticksToNanoseconds(ticks, frequency());
+    }
+
+    [[nodiscard]] static bool isTsc() noexcept
+    {
+        return useTsc_;
+    }
+
+    static void recalibrate() noexcept
+    {
+        calibration().recalibrate();
+    }
+
+private:
+    struct Clock
+    {
+        [[nodiscard]] static uint64_t readTsc() noexcept
+        {
+            return __rdtsc();
+        }
+
+        [[nodiscard]] static int64_t readCounter() noexcept
+        {
+            LARGE_INTEGER counter;
+            QueryPerformanceCounter(&counter);
+            return counter.QuadPart;
+        }
+
+        [[nodiscard]] static int64_t counterFrequency() noexcept
+        {
+            static const int64_t frequency = []
+            {
+                LARGE_INTEGER frequency;
+                QueryPerformanceFrequency(&frequency);
+                return frequency.QuadPart;
+            }();
+            return frequency;
+        }
+
+        [[nodiscard]] static bool hasInvariantTsc() noexcept
+        {
+            std::array<int, 4> registers{};
+            __cpuid(registers.data(), 0x8000'0000);
+            if (static_cast<unsigned>(registers[0]) < 0x8000'0007)
+            {
+                return false;
+            }
+
+            __cpuid(registers.data(), 0x8000'0007);
+            return (registers[3] & (1 << 8)) != 0; // EDX bit 8
+        }
+    };
+
+    [[nodiscard]] static TscCalibration<Clock>& calibration() noexcept
+    {
+        static TscCalibration<Clock> calibration;
+        return calibration;
+    }
+
+    static inline const bool useTsc_ = calibration().isTsc();
+};
+
+// Counters behind the status bar metrics. All updates are lock-free, so they can be fed from any thread.
+class InputMetrics
+{
+public:
+    // Indexed by RAWINPUTHEADER::dwType
+    static constexpr size_t deviceTypeCount = RIM_TYPEHID + 1;
+
+    struct Snapshot
+    {
+        int64_t time;
+        std::array<uint64_t, deviceTypeCount> events;
+        uint64_t dropped;
+        uint64_t overruns;
+    };
+
+    // Counts an event and records the interval since the previous event of the same device type
+    void countEvent(DWORD deviceType, int64_t time) noexcept
+    {
+        const size_t index = std::min<size_t>(deviceType, deviceTypeCount - 1);
+        events_[index].fetch_add(1, std::memory_order_relaxed);
+        if (const int64_t previous = lastEventTimes_[index].exchange(time, std::memory_order_relaxed); previous != 0 && time > previous)
+        {
+            intervals_[index].record(PerformanceCounter::toNanoseconds(time - previous));
+        }
+    }
+
+    void countDropped(uint64_t count = 1) noexcept
+    {
+        dropped_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void countOverrun() noexcept
+    {
+        overruns_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Time from the arrival of WM_INPUT to the event being displayed
+    void recordLatency(int64_t ingestTime) noexcept
+    {
+        latency_.record(PerformanceCounter::toNanoseconds(PerformanceCounter::now() - ingestTime));
+    }
+
+    void resetDistributions() noexcept
+    {
+        latency_.reset();
+        for (size_t i = 0; i < deviceTypeCount; ++i)
+        {
+            intervals_[i].reset();
+            lastEventTimes_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    [[nodiscard]] const Histogram<>& latency() const noexcept
+    {
+        return latency_;
+    }
+
+    [[nodiscard]] const Histogram<>& intervals(DWORD deviceType) const noexcept
+    {
+        return intervals_[std::min<size_t>(deviceType, deviceTypeCount - 1)];
+    }
+
+    [[nodiscard]] Snapshot snapshot() const noexcept
+    {
+        Snapshot snapshot{.time = PerformanceCounter::now()};
+        for (size_t i = 0; i < deviceTypeCount; ++i)
+        {
+            snapshot.events[i] = events_[i].load(std::memory_order_relaxed);
+        }
+        snapshot.dropped = dropped_.load(std::memory_order_relaxed);
+        snapshot.overruns = overruns_.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, deviceTypeCount> events_{};
+    std::atomic<uint64_t> dropped_{};
+    std::atomic<uint64_t> overruns_{};
+    std::array<std::atomic<int64_t>, deviceTypeCount> lastEventTimes_{};
+    std::array<Histogram<>, deviceTypeCount> intervals_;
+    Histogram<> latency_;
+};
+
+// Per-device counters for every reason a keyboard event is dropped or rewritten by the adjustment.
+// Every event increments exactly one disposition counter; the rewrite counters are incremented by
+// the corresponding adjustment flags, so counting doesn't need to branch. There must only be a
+// single writer, readers may be on any thread.
+class KeyboardEventCounters
+{
+public:
+    enum class Counter : uint32_t
+    {
+        // Dispositions, see KeyboardDisposition
+        Accepted,
+        Overrun,
+        PrefixSwallowed,
+        ZeroMakeCode,
+
+        // Rewrites, see AdjustmentFlags
+        MakeCodeMapped,
+        VirtualKeyAdjusted,
+
+        Count
+    };
+
+    // Rewrites only count for accepted events, a dropped event may have been partially rewritten
+    void count(KeyboardDisposition disposition, AdjustmentFlags adjustments) noexcept
+    {
+        const uint64_t accepted = disposition == KeyboardDisposition::Accepted ? 1 : 0;
+        increment(static_cast<Counter>(disposition), 1);
+        increment(Counter::MakeCodeMapped, accepted * std::to_underlying(adjustments & AdjustmentFlags::MakeCodeMapped) / std::to_underlying(AdjustmentFlags::MakeCodeMapped));
+        increment(Counter::VirtualKeyAdjusted, accepted * std::to_underlying(adjustments & AdjustmentFlags::VirtualKeyAdjusted) / std::to_underlying(AdjustmentFlags::VirtualKeyAdjusted));
+    }
+
+    [[nodiscard]] uint64_t get(Counter counter) const noexcept
+    {
+        return counters_[std::to_underlying(counter)].load(std::memory_order_relaxed);
+    }
+
+    void serialize(std::vector<std::byte>& out) const
+    {
+        appendVarUInt(out, counters_.size());
+        for (const auto& counter : counters_)
+        {
+            appendVarUInt(out, counter.load(std::memory_order_relaxed));
+        }
+    }
+
+    // Counters unknown to this version are skipped, missing ones are zero
+    [[nodiscard]] bool deserialize(std::span<const std::byte>& in) noexcept
+    {
+        uint64_t size = 0;
+        if (!readVarUInt(in, size))
+        {
+            return false;
+        }
+
+        for (uint64_t i = 0; i < size; ++i)
+        {
+            uint64_t value = 0;
+            if (!readVarUInt(in, value))
+            {
+                return false;
+            }
+            if (i < counters_.size())
+            {
+                counters_[static_cast<size_t>(i)].store(value, std::memory_order_relaxed);
+            }
+        }
+        return true;
+    }
+
+private:
+    void increment(Counter counter, uint64_t value) noexcept
+    {
+        auto& c = counters_[std::to_underlying(counter)];
+        c.store(c.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<uint64_t>, std::to_underlying(Counter::Count)> counters_{};
+};
+
+// Per-device state indexed by DeviceRegistry index. Most devices only ever use a few of the tables, so entries are
+// allocated on their first use. They stay after a device's removal, so it still shows in reports, until reset()
+// when the registry gives the index to another device. Entries never move, so references stay valid.
+template<typename T>
+class DeviceTable
+{
+public:
+    static constexpr size_t capacity = size_t{std::numeric_limits<uint8_t>::max()} + 1; // One per registry index
+
+    [[nodiscard]] T& operator[](uint8_t index)
+    {
+        std::unique_ptr<T>& entry = entries_[index];
+        if (!entry)
+        {
+            entry = std::make_unique<T>();
+        }
+        return *entry;
+    }
+
+    void reset(uint8_t index) noexcept
+    {
+        entries_[index].reset();
+    }
+
+    [[nodiscard]] T* find(uint8_t index) noexcept
+    {
+        return entries_[index].get();
+    }
+
+    [[nodiscard]] const T* find(uint8_t index) const noexcept
+    {
+        return entries_[index].get();
+    }
+
+    template<typename F>
+    void forEach(F&& f)
+    {
+        for (size_t i = 0; i < capacity; ++i)
+        {
+            if (entries_[i])
+            {
+                f(static_cast<uint8_t>(i), *entries_[i]);
+            }
+        }
+    }
+
+    template<typename F>
+    void forEach(F&& f) const
+    {
+        for (size_t i = 0; i < capacity; ++i)
+        {
+            if (entries_[i])
+            {
+                f(static_cast<uint8_t>(i), std::as_const(*entries_[i]));
+            }
+        }
+    }
+
+private:
+    std::array<std::unique_ptr<T>, capacity> entries_;
+};
+
+// Append-only column stored in fixed-size chunks, so growing never moves existing elements and
+// allocates at most once per chunk. clear() keeps the chunks, so refilling doesn't allocate.
+template<typename T, size_t ChunkSize = 65536>
+    requires std::is_trivially_copyable_v<T>
+class ChunkedColumn
+{
+public:
+    static_assert(std::has_single_bit(ChunkSize), "ChunkSize must be a power of two");
+
+    static constexpr size_t chunkSize = ChunkSize;
+
+    ChunkedColumn(const ChunkedColumn&) = delete;
+    ChunkedColumn& operator=(const ChunkedColumn&) = delete;
+
+    ChunkedColumn() noexcept = default;
+
+    void push_back(const T& value)
+    {
+        if (size_ == chunks_.size() * ChunkSize)
+        {
+            chunks_.push_back(std::make_unique_for_overwrite<T[]>(ChunkSize));
+        }
+        chunks_[size_ / ChunkSize][size_ % ChunkSize] = value;
+        ++size_;
+    }
+
+    [[nodiscard]] T& operator[](size_t index) noexcept
+    {
+        _ASSERT(index < size_);
+        return chunks_[index / ChunkSize][index % ChunkSize];
+    }
+
+    [[nodiscard]] const T& operator[](size_t index) const noexcept
+    {
+        _ASSERT(index < size_);
+        return chunks_[index / ChunkSize][index % ChunkSize];
+    }
+
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    // Number of chunks holding elements; all but the last one are full
+    [[nodiscard]] size_t chunkCount() const noexcept
+    {
+        return (size_ + ChunkSize - 1) / ChunkSize;
+    }
+
+    [[nodiscard]] std::span<const T> chunk(size_t index) const noexcept
+    {
+        _ASSERT(index < chunkCount());
+        return {chunks_[index].get(), std::min(ChunkSize, size_ - index * ChunkSize)};
+    }
+
+    [[nodiscard]] std::span<T> chunk(size_t index) noexcept
+    {
+        _ASSERT(index < chunkCount());
+        return {chunks_[index].get(), std::min(ChunkSize, size_ - index * ChunkSize)};
+    }
+
+    void clear() noexcept
+    {
+        size_ = 0;
+    }
+
+private:
+    std::vector<std::unique_ptr<T[]>> chunks_;
+    size_t size_{};
+};
+
+// Columnar store of key holds, i.e. key-down to key-up intervals. Timestamps are performance counter ticks.
+struct HoldIntervalStore
+{
+    enum class Flags : uint8_t
+    {
+        None = 0,
+        MissingUp = 0b0001 // No key-up was seen; up is the time the hold was abandoned
+    };
+
+    void append(uint8_t deviceIndex, USHORT lookupCode, int64_t downTime, int64_t upTime, uint32_t repeatCount, Flags flag)
+    {
+        device.push_back(deviceIndex);
+        key.push_back(lookupCode);
+        down.push_back(downTime);
+        up.push_back(upTime);
+        repeats.push_back(repeatCount);
+        flags.push_back(flag);
+    }
+
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return key.size();
+    }
+
+    void clear() noexcept
+    {
+        device.clear();
+        key.clear();
+        down.clear();
+        up.clear();
+        repeats.clear();
+        flags.clear();
+    }
+
+    ChunkedColumn<uint8_t> device; // DeviceRegistry index
+    ChunkedColumn<USHORT> key;
+    ChunkedColumn<int64_t> down;
+    ChunkedColumn<int64_t> up;
+    ChunkedColumn<uint32_t> repeats; // Typematic repeats (key-downs while held)
+    ChunkedColumn<Flags> flags;
+};
+
+// Pairs key-downs with key-ups of a single device in O(1) using a pressed-state table indexed by lookup code
+class KeyHoldTracker
+{
+public:
+    static constexpr size_t keyCount = 0x200; // Lookup codes are 9 bits, see RawKeyboard::getLookupCode()
+
+    void onKey(uint8_t device, USHORT lookupCode, bool isDown, int64_t time, HoldIntervalStore& store)
+    {
+        Key& key = keys_[lookupCode & (keyCount - 1)];
+        if (isDown)
+        {
+            if (key.downTime != 0)
+            {
+                ++key.repeats;
+            }
+            else
+            {
+                key = {.downTime = time, .repeats = 0};
+            }
+        }
+        else if (key.downTime != 0)
+        {
+            store.append(device, lookupCode, key.downTime, time, key.repeats, HoldIntervalStore::Flags::None);
+            key.downTime = 0;
+        }
+        else
+        {
+            ++duplicateUps_;
+        }
+    }
+
+    // Ends all holds in progress, e.g. when key-ups can't be received any longer
+    void flush(uint8_t device, int64_t time, HoldIntervalStore& store)
+    {
+        for (size_t i = 0; i < keyCount; ++i)
+        {
+            if (Key& key = keys_[i]; key.downTime != 0)
+            {
+                store.append(device, static_cast<USHORT>(i), key.downTime, time, key.repeats, HoldIntervalStore::Flags::MissingUp);
+                key.downTime = 0;
+                ++missingUps_;
+            }
+        }
+    }
+
+    // Key-ups without a preceding key-down
+    [[nodiscard]] uint64_t duplicateUps() const noexcept
+    {
+        return duplicateUps_;
+    }
+
+    // Holds ended by flush()
+    [[nodiscard]] uint64_t missingUps() const noexcept
+    {
+        return missingUps_;
+    }
+
+private:
+    struct Key
+    {
+        int64_t downTime; // Zero if not pressed
+        uint32_t repeats;
+    };
+
+    std::array<Key, keyCount> keys_{};
+    uint64_t duplicateUps_{};
+    uint64_t missingUps_{};
+};
+
+// Set of keys indexed by lookup code. Comparisons and population counts process 128 bits at a time with SSE2.
+class alignas(64) KeyBitset
+{
+public:
+    static constexpr size_t keyCount = 0x200; // Lookup codes are 9 bits, see RawKeyboard::getLookupCode()
+
+    void set(USHORT lookupCode, bool value) noexcept
+    {
+        const uint64_t bit = uint64_t{1} << (lookupCode % 64);
+        uint64_t& word = words_[(lookupCode & (keyCount - 1)) / 64];
+        word = value ? word | bit : word & ~bit;
+    }
+
+    [[nodiscard]] bool test(USHORT lookupCode) const noexcept
+    {
+        return (words_[(lookupCode & (keyCount - 1)) / 64] >> (lookupCode % 64) & 1) != 0;
+    }
+
+    void reset() noexcept
+    {
+        words_.fill(0);
+    }
+
+    [[nodiscard]] bool none() const noexcept
+    {
+        __m128i any = _mm_setzero_si128();
+        for (size_t i = 0; i < laneCount; ++i)
+        {
+            any = _mm_or_si128(any, lane(i));
+        }
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(any, _mm_setzero_si128())) == 0xffff;
+    }
+
+    [[nodiscard]] bool operator==(const KeyBitset& other) const noexcept
+    {
+        __m128i equal = _mm_set1_epi8(-1);
+        for (size_t i = 0; i < laneCount; ++i)
+        {
+            equal = _mm_and_si128(equal, _mm_cmpeq_epi8(lane(i), other.lane(i)));
+        }
+        return _mm_movemask_epi8(equal) == 0xffff;
+    }
+
+    [[nodiscard]] size_t count() const noexcept
+    {
+        // Per-byte population counts (at most 8 per lane and byte, so the sum over all lanes fits a byte)
+        const __m128i m1 = _mm_set1_epi8(0x55);
+        const __m128i m2 = _mm_set1_epi8(0x33);
+        const __m128i m4 = _mm_set1_epi8(0x0f);
+        __m128i bytes = _mm_setzero_si128();
+        for (size_t i = 0; i < laneCount; ++i)
+        {
+            __m128i x = lane(i);
+            x = _mm_sub_epi8(x, _mm_and_si128(_mm_srli_epi64(x, 1), m1));
+            x = _mm_add_epi8(_mm_and_si128(x, m2), _mm_and_si128(_mm_srli_epi64(x, 2), m2));
+            x = _mm_and_si128(_mm_add_epi8(x, _mm_srli_epi64(x, 4)), m4);
+            bytes = _mm_add_epi8(bytes, x);
+        }
+
+        // Horizontal sum of the bytes into the two 64-bit halves
+        const __m128i sums = _mm_sad_epu8(bytes, _mm_setzero_si128());
+        return static_cast<size_t>(_mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(sums, sums)));
+    }
+
+    [[nodiscard]] size_t hash() const noexcept
+    {
+        uint64_t hash = 0;
+        for (const uint64_t word : words_)
+        {
+            hash = (hash ^ word) * 0x9e3779b97f4a7c15;
+        }
+        return static_cast<size_t>(hash ^ hash >> 32);
+    }
+
+    template<typename F>
+    void forEach(F&& f) const
+    {
+        for (size_t i = 0; i < words_.size(); ++i)
+        {
+            for (uint64_t word = words_[i]; word != 0; word &= word - 1)
+            {
+                f(static_cast<USHORT>(i * 64 + std::countr_zero(word)));
+            }
+        }
+    }
+
+private:
+    static constexpr size_t laneCount = keyCount / 128;
+
+    [[nodiscard]] __m128i lane(size_t index) const noexcept
+    {
+        return _mm_load_si128(reinterpret_cast<const __m128i*>(words_.data()) + index);
+    }
+
+    std::array<uint64_t, keyCount / 64> words_{};
+};
+
+// Tracks the pressed keys of a single device to assess its n-key rollover. A key-up for a key that isn't
+// pressed while other keys are held means the keyboard blocked the key-down, i.e. the key was ghosted.
+class RolloverAnalyzer
+{
+public:
+    struct Chord
+    {
+        KeyBitset keys;
+        uint32_t count;
+    };
+
+    struct BlockedKey
+    {
+        KeyBitset held;
+        USHORT lookupCode;
+    };
+
+    static constexpr size_t maxChords = 1024;
+    static constexpr size_t maxBlockedKeys = 64;
+
+    RolloverAnalyzer()
+    {
+        chords_.reserve(maxChords);
+        blockedKeys_.reserve(maxBlockedKeys);
+    }
+
+    void onKey(USHORT lookupCode, bool isDown)
+    {
+        if (isDown)
+        {
+            if (!pressed_.test(lookupCode))
+            {
+                pressed_.set(lookupCode, true);
+                maxPressed_ = std::max(maxPressed_, pressed_.count());
+                isChordComplete_ = false;
+            }
+        }
+        else if (pressed_.test(lookupCode))
+        {
+            // A chord is complete with the first key-up after a key-down
+            if (!isChordComplete_)
+            {
+                recordChord();
+                isChordComplete_ = true;
+            }
+            pressed_.set(lookupCode, false);
+        }
+        else if (!pressed_.none())
+        {
+            if (blockedKeys_.size() < maxBlockedKeys)
+            {
+                blockedKeys_.push_back({.held = pressed_, .lookupCode = lookupCode});
+            }
+            ++blockedKeyCount_;
+        }
+    }
+
+    // Forgets the pressed keys, e.g. when key-ups can't be received any longer
+    void release() noexcept
+    {
+        pressed_.reset();
+        isChordComplete_ = true;
+    }
+
+    void resetStatistics() noexcept
+    {
+        chords_.clear();
+        chordSlots_.fill(0);
+        blockedKeys_.clear();
+        maxPressed_ = pressed_.count();
+        blockedKeyCount_ = 0;
+        droppedChords_ = 0;
+    }
+
+    [[nodiscard]] const KeyBitset& pressed() const noexcept
+    {
+        return pressed_;
+    }
+
+    [[nodiscard]] size_t maxPressed() const noexcept
+    {
+        return maxPressed_;
+    }
+
+    // Distinct chords of two or more keys and how often each was seen
+    [[nodiscard]] std::span<const Chord> chords() const noexcept
+    {
+        return chords_;
+    }
+
+    // Chords not recorded because maxChords distinct ones were seen already
+    [[nodiscard]] uint64_t droppedChords() const noexcept
+    {
+        return droppedChords_;
+    }
+
+    // The first maxBlockedKeys blocked keys and the keys held at the time
+    [[nodiscard]] std::span<const BlockedKey> blockedKeys() const noexcept
+    {
+        return blockedKeys_;
+    }
+
+    [[nodiscard]] uint64_t blockedKeyCount() const noexcept
+    {
+        return blockedKeyCount_;
+    }
+
+private:
+    void recordChord()
+    {
+        if (pressed_.count() < 2)
+        {
+            return;
+        }
+
+        // Linear probing; the table is at most half full, so a probe ends at an empty slot
+        for (size_t slot = pressed_.hash();; ++slot)
+        {
+            uint16_t& entry = chordSlots_[slot & (chordSlotCount - 1)];
+            if (entry == 0)
+            {
+                if (chords_.size() < maxChords)
+                {
+                    chords_.push_back({.keys = pressed_, .count = 1});
+                    entry = static_cast<uint16_t>(chords_.size());
+                }
+                else
+                {
+                    ++droppedChords_;
+                }
+                return;
+            }
+
+            if (Chord& chord = chords_[entry - 1]; chord.keys == pressed_)
+            {
+                ++chord.count;
+                return;
+            }
+        }
+    }
+
+    static constexpr size_t chordSlotCount = 2 * maxChords;
+    static_assert(std::has_single_bit(chordSlotCount));
+
+    KeyBitset pressed_;
+    std::vector<Chord> chords_;
+    std::array<uint16_t, chordSlotCount> chordSlots_{}; // Chord index + 1 by hash of the keys, 0 if empty
+    std::vector<BlockedKey> blockedKeys_;
+    size_t maxPressed_{};
+    uint64_t blockedKeyCount_{};
+    uint64_t droppedChords_{};
+    bool isChordComplete_{true};
+};
+
+// Columnar store of the keyboard events shown in the list view; an event's index is its list view item index.
+// Devices are stored as DeviceRegistry indexes. Timestamps are performance counter ticks.
+struct KeyboardEventStore
+{
+    void append(uint8_t deviceIndex, USHORT lookupCode, bool isKeyDown, int64_t timestamp, EventMarkers marker, const KeyBitset& pressedKeys)
+    {
+        device.push_back(deviceIndex);
+        key.push_back(lookupCode);
+        isDown.push_back(isKeyDown);
+        time.push_back(timestamp);
+        markers.push_back(marker);
+        pressed.push_back(pressedKeys);
+    }
+
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return key.size();
+    }
+
+    void clear() noexcept
+    {
+        device.clear();
+        key.clear();
+        isDown.clear();
+        time.clear();
+        markers.clear();
+        pressed.clear();
+    }
+
+    ChunkedColumn<uint8_t> device; // DeviceRegistry index
+    ChunkedColumn<USHORT> key;
+    ChunkedColumn<bool> isDown;
+    ChunkedColumn<int64_t> time;
+    ChunkedColumn<EventMarkers> markers;
+    ChunkedColumn<KeyBitset, 4096> pressed; // The device's pressed keys after the event
+};
+
+// Columnar store of mouse events; an event's index is its mouse list view item index. Devices are stored as
+// DeviceRegistry indexes, which keeps an event at 31 bytes. Timestamps are performance counter ticks.
+// dx and dy keep the values as received; analyzers use motionX and motionY, which hold the relative motion of
+// absolute events as well.
+struct MouseEventStore
+{
+    // Totals over the events of a device, in mouse counts and wheel units
+    struct Aggregates
+    {
+        uint64_t count;
+        int64_t x;
+        int64_t y;
+        uint64_t distanceX;
+        uint64_t distanceY;
+        std::array<uint64_t, 5> buttonDowns;
+        int64_t wheel;
+        int64_t hwheel;
+    };
+
+    void append(uint8_t deviceIndex, const RAWMOUSE& mouse, int64_t timestamp)
+    {
+        const bool isAbsolute = (mouse.usFlags & MOUSE_MOVE_ABSOLUTE) != 0;
+        dx.push_back(static_cast<int32_t>(mouse.lLastX));
+        dy.push_back(static_cast<int32_t>(mouse.lLastY));
+        motionX.push_back(isAbsolute ? 0 : static_cast<int32_t>(mouse.lLastX));
+        motionY.push_back(isAbsolute ? 0 : static_cast<int32_t>(mouse.lLastY));
+        buttonFlags.push_back(mouse.usButtonFlags);
+        buttonData.push_back(static_cast<SHORT>(mouse.usButtonData));
+        flags.push_back(mouse.usFlags);
+        device.push_back(deviceIndex);
+        time.push_back(timestamp);
+    }
+
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return time.size();
+    }
+
+    void clear() noexcept
+    {
+        dx.clear();
+        dy.clear();
+        motionX.clear();
+        motionY.clear();
+        buttonFlags.clear();
+        buttonData.clear();
+        flags.clear();
+        device.clear();
+        time.clear();
+    }
+
+    // The loops are branchless and work on whole chunks, so the compiler can vectorize them
+    [[nodiscard]] Aggregates aggregate(uint8_t deviceIndex) const noexcept
+    {
+        Aggregates totals{};
+        for (size_t c = 0; c < time.chunkCount(); ++c)
+        {
+            const std::span<const uint8_t> devicesChunk = device.chunk(c);
+            const std::span<const int32_t> dxChunk = motionX.chunk(c);
+            const std::span<const int32_t> dyChunk = motionY.chunk(c);
+            const std::span<const USHORT> buttonFlagsChunk = buttonFlags.chunk(c);
+            const std::span<const SHORT> buttonDataChunk = buttonData.chunk(c);
+
+            uint64_t count = 0;
+            int64_t x = 0;
+            int64_t y = 0;
+            uint64_t distanceX = 0;
+            uint64_t distanceY = 0;
+            for (size_t i = 0; i < devicesChunk.size(); ++i)
+            {
+                const int64_t mask = -static_cast<int64_t>(devicesChunk[i] == deviceIndex);
+                count -= mask;
+                x += dxChunk[i] & mask;
+                y += dyChunk[i] & mask;
+                distanceX += static_cast<uint64_t>(std::abs(static_cast<int64_t>(dxChunk[i])) & mask);
+                distanceY += static_cast<uint64_t>(std::abs(static_cast<int64_t>(dyChunk[i])) & mask);
+            }
+
+            std::array<uint64_t, 5> buttonDowns{};
+            int64_t wheel = 0;
+            int64_t hwheel = 0;
+            for (size_t i = 0; i < devicesChunk.size(); ++i)
+            {
+                const uint32_t selected = devicesChunk[i] == deviceIndex ? buttonFlagsChunk[i] : 0;
+                for (size_t button = 0; button < buttonDowns.size(); ++button)
+                {
+                    // RI_MOUSE_BUTTON_1_DOWN, RI_MOUSE_BUTTON_2_DOWN, ... are every other bit
+                    buttonDowns[button] += (selected >> (button * 2)) & 1;
+                }
+                wheel += (selected & RI_MOUSE_WHEEL) != 0 ? buttonDataChunk[i] : 0;
+                hwheel += (selected & RI_MOUSE_HWHEEL) != 0 ? buttonDataChunk[i] : 0;
+            }
+
+            totals.count += count;
+            totals.x += x;
+            totals.y += y;
+            totals.distanceX += distanceX;
+            totals.distanceY += distanceY;
+            for (size_t button = 0; button < buttonDowns.size(); ++button)
+            {
+                totals.buttonDowns[button] += buttonDowns[button];
+            }
+            totals.wheel += wheel;
+            totals.hwheel += hwheel;
+        }
+        return totals;
+    }
+
+    ChunkedColumn<int32_t> dx; // As received, i.e. 0..65535 for MOUSE_MOVE_ABSOLUTE events
+    ChunkedColumn<int32_t> dy;
+    ChunkedColumn<int32_t> motionX; // Counts, or pixels for absolute events once AbsoluteMouseNormalizer has run, zero before
+    ChunkedColumn<int32_t> motionY;
+    ChunkedColumn<USHORT> buttonFlags;
+    ChunkedColumn<SHORT> buttonData; // Wheel delta if RI_MOUSE_WHEEL or RI_MOUSE_HWHEEL is set
+    ChunkedColumn<USHORT> flags;
+    ChunkedColumn<uint8_t> device;
+    ChunkedColumn<int64_t> time;
+};
+
+// Flags key transitions (down to up or up to down) that follow the previous transition of the same key
+// within a window, which is what a bouncing switch looks like. Typematic repeats aren't transitions.
+class ChatterDetector
+{
+public:
+    static constexpr size_t keyCount = 0x200; // Lookup codes are 9 bits, see RawKeyboard::getLookupCode()
+
+    // Returns true if the event chatters
+    bool onKey(USHORT lookupCode, bool isDown, int64_t time, int64_t window) noexcept
+    {
+        const size_t index = lookupCode & (keyCount - 1);
+        Key& key = keys_[index];
+        if (isDown == key.isDown)
+        {
+            return false;
+        }
+
+        const bool chatters = key.lastTransition != 0 && time - key.lastTransition < window;
+        key = {.lastTransition = time, .isDown = isDown};
+        counts_[index] += chatters ? 1 : 0;
+        return chatters;
+    }
+
+    [[nodiscard]] uint32_t count(size_t lookupCode) const noexcept
+    {
+        return counts_[lookupCode & (keyCount - 1)];
+    }
+
+    [[nodiscard]] uint64_t total() const noexcept
+    {
+        return std::accumulate(counts_.begin(), counts_.end(), uint64_t{0});
+    }
+
+    void resetCounts() noexcept
+    {
+        counts_.fill(0);
+    }
+
+    // Re-runs detection over all stored events, e.g. after the window changed, rewriting the chatter markers
+    // and the per-key counts of the detectors
+    static void analyze(KeyboardEventStore& store, int64_t window, DeviceTable<ChatterDetector>& detectors);
+
+private:
+    struct Key
+    {
+        int64_t lastTransition; // Zero if the key never changed state
+        bool isDown;
+    };
+
+    struct Partition;
+
+    std::array<Key, keyCount> keys_{};
+    std::array<uint32_t, keyCount> counts_{};
+};
+
+// The lookup codes first, first + stride, first + 2 * stride, ... of all devices
+struct ChatterDetector::Partition
+{
+    void analyze(KeyboardEventStore& store, int64_t window, size_t firstKey, size_t stride)
+    {
+        for (size_t i = 0; i < store.size(); ++i)
+        {
+            if (const USHORT key = store.key[i]; (key & (keyCount - 1)) % stride == firstKey)
+            {
+                const bool chatters = detectors[store.device[i]].onKey(key, store.isDown[i], store.time[i], window);
+                EventMarkers& markers = store.markers[i];
+                markers = chatters ? markers | EventMarkers::Chatter : markers & ~EventMarkers::Chatter;
+            }
+        }
+    }
+
+    DeviceTable<ChatterDetector> detectors;
+};
+
+// Chatter only depends on earlier events of the same device and key, so lookup codes are partitioned
+// across threads and each thread scans the store for its own keys
+inline void ChatterDetector::analyze(KeyboardEventStore& store, int64_t window, DeviceTable<ChatterDetector>& detectors)
+{
+    constexpr size_t minEventsPerThread = 65536;
+    const size_t threadCount = std::clamp<size_t>(store.size() / minEventsPerThread, 1, std::max(std::thread::hardware_concurrency(), 1u));
+
+    std::vector<Partition> partitions(threadCount);
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(threadCount - 1);
+        for (size_t i = 1; i < threadCount; ++i)
+        {
+            threads.emplace_back([&, i] { partitions[i].analyze(store, window, i, threadCount); });
+        }
+        partitions[0].analyze(store, window, 0, threadCount);
+    }
+
+    detectors.forEach([](uint8_t, ChatterDetector& detector) { detector = {}; });
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        partitions[i].detectors.forEach(
+            [&](uint8_t device, const ChatterDetector& from)
+            {
+                ChatterDetector& to = detectors[device];
+                for (size_t key = i; key < keyCount; key += threadCount)
+                {
+                    to.keys_[key] = from.keys_[key];
+                    to.counts_[key] = from.counts_[key];
+                }
+            });
+    }
+}
+
+// Virtual keys the current keyboard layout assigns to each lookup code. Some keys legitimately report one of two
+// virtual keys, e.g. VK_LSHIFT or VK_SHIFT depending on adjustment, or VK_LEFT or VK_NUMPAD4 depending on Num Lock.
+class VirtualKeyTable
+{
+public:
+    static constexpr size_t keyCount = 0x200; // Lookup codes are 9 bits, see RawKeyboard::getLookupCode()
+
+    VirtualKeyTable() noexcept
+    {
+        rebuild(GetKeyboardLayout(0));
+    }
+
+    void rebuild(HKL layout) noexcept
+    {
+        for (size_t code = 0; code < keyCount; ++code)
+        {
+            const UINT scanCode = static_cast<UINT>((code & 0x100) != 0 ? 0xe000 | (code & 0xff) : code);
+            const UINT vkey = MapVirtualKeyExW(scanCode, MAPVK_VSC_TO_VK_EX, layout);
+            keys_[code] = {.expected = static_cast<uint8_t>(vkey), .alternate = static_cast<uint8_t>(unsided(vkey))};
+        }
+
+        // Number pad keys without E0 report digits while Num Lock is on
+        for (UINT vkey = VK_NUMPAD0; vkey <= VK_DECIMAL; vkey = vkey == VK_NUMPAD9 ? VK_DECIMAL : vkey + 1)
+        {
+            if (const UINT scanCode = MapVirtualKeyExW(vkey, MAPVK_VK_TO_VSC, layout); scanCode != 0 && scanCode < 0x100)
+            {
+                keys_[scanCode].alternate = static_cast<uint8_t>(vkey);
+            }
+        }
+
+        // Pause and Num Lock share scan code 0x45, see adjustKeyboardInput()
+        keys_[0x045] = {.expected = VK_PAUSE, .alternate = VK_NUMLOCK};
+        keys_[0x145] = {.expected = VK_NUMLOCK, .alternate = VK_NUMLOCK};
+    }
+
+    // Unmapped lookup codes and events without a virtual key (0xff) match anything
+    [[nodiscard]] bool matches(USHORT lookupCode, USHORT vkey) const noexcept
+    {
+        const Key key = keys_[lookupCode & (keyCount - 1)];
+        return key.expected == 0 || vkey == 0xff || vkey == key.expected || vkey == key.alternate;
+    }
+
+private:
+    struct Key
+    {
+        uint8_t expected;
+        uint8_t alternate;
+    };
+
+    [[nodiscard]] static UINT unsided(UINT vkey) noexcept
+    {
+        switch (vkey)
+        {
+            case VK_LSHIFT:
+            case VK_RSHIFT:
+                return VK_SHIFT;
+            case VK_LCONTROL:
+            case VK_RCONTROL:
+                return VK_CONTROL;
+            case VK_LMENU:
+            case VK_RMENU:
+                return VK_MENU;
+        }
+        return vkey;
+    }
+
+    std::array<Key, keyCount> keys_{};
+};
+
+// Flags keyboard events a healthy keyboard and driver don't produce: keys held beyond a threshold, key-ups
+// without a key-down, E0/E1 sequences interrupted by another key, virtual keys contradicting the scan code,
+// and time running backwards. Each event is a constant amount of work on the state of its own key.
+class InputValidator
+{
+public:
+    static constexpr size_t keyCount = 0x200; // Lookup codes are 9 bits, see RawKeyboard::getLookupCode()
+
+    struct Counts
+    {
+        uint64_t stuckKeys;
+        uint64_t orphanKeyUps;
+        uint64_t brokenSequences;
+        uint64_t virtualKeyMismatches;
+        uint64_t timeRegressions;
+    };
+
+    // Keys start out released: the first key-up may end a press from before the device was first seen, like that of
+    // the Enter that started the program
+    InputValidator() noexcept
+    {
+        release();
+    }
+
+    // Expects prefixes as well, i.e. the E1 of Pause and the fake shifts around E0 keys, as they open sequences
+    [[nodiscard]] EventMarkers onKey(const RawKeyboard& rawKbd, int64_t time, int64_t stuckThreshold, const VirtualKeyTable& vkeys) noexcept
+    {
+        const bool isE0 = (rawKbd.Flags & RI_KEY_E0) != 0;
+        const bool isE1 = (rawKbd.Flags & RI_KEY_E1) != 0;
+        const bool isFakeShift = isE0 && rawKbd.MakeCode == 0x2a;
+        const bool isPrefix = isE1 || isFakeShift;
+
+        // An E1 must be followed by the 0x45 of Pause, a fake shift leading an E0 key by that key. Fake shifts
+        // directly after an E0 key trail it, e.g. when Shift is held, and don't open a sequence.
+        const bool continuesE1 = !isE0 && !isE1 && rawKbd.MakeCode == 0x45;
+        const bool isE0Key = isE0 && !isPrefix;
+        const bool continues = pendingSequence_ == ScanCodeSequence::E1 ? continuesE1 : pendingSequence_ != ScanCodeSequence::E0 || isE0Key;
+        pendingSequence_ = isE1 ? ScanCodeSequence::E1 : isFakeShift && !afterE0Key_ ? ScanCodeSequence::E0 : ScanCodeSequence::None;
+        afterE0Key_ = isE0Key;
+
+        const bool regresses = time < lastTime_;
+        lastTime_ = std::max(time, lastTime_);
+
+        EventMarkers markers = (continues ? EventMarkers{0} : EventMarkers::BrokenSequence) | (regresses ? EventMarkers::TimeRegression : EventMarkers{0});
+        if (!isPrefix)
+        {
+            const USHORT lookupCode = rawKbd.getLookupCode();
+            Key& key = keys_[lookupCode & (keyCount - 1)];
+            const bool isHeld = key.downTime != 0;
+            const bool stuck = isHeld && !key.isStuck && time - key.downTime > stuckThreshold;
+            const bool orphan = !rawKbd.isKeyDown && !isHeld && !key.isReleased;
+            const bool mismatch = !vkeys.matches(lookupCode, rawKbd.VKey);
+            markers |= (stuck ? EventMarkers::StuckKey : EventMarkers{0}) | (orphan ? EventMarkers::OrphanKeyUp : EventMarkers{0}) | (mismatch ? EventMarkers::VirtualKeyMismatch : EventMarkers{0});
+
+            // Repeats keep the time of the first key-down
+            key = {.downTime = rawKbd.isKeyDown ? (isHeld ? key.downTime : time) : 0, .isStuck = rawKbd.isKeyDown && (key.isStuck || stuck)};
+        }
+
+        counts_.stuckKeys += (markers & EventMarkers::StuckKey) != EventMarkers{0} ? 1 : 0;
+        counts_.orphanKeyUps += (markers & EventMarkers::OrphanKeyUp) != EventMarkers{0} ? 1 : 0;
+        counts_.brokenSequences += (markers & EventMarkers::BrokenSequence) != EventMarkers{0} ? 1 : 0;
+        counts_.virtualKeyMismatches += (markers & EventMarkers::VirtualKeyMismatch) != EventMarkers{0} ? 1 : 0;
+        counts_.timeRegressions += (markers & EventMarkers::TimeRegression) != EventMarkers{0} ? 1 : 0;
+        return markers;
+    }
+
+    // Finds keys that became stuck without further events, as a stuck key doesn't necessarily repeat. Returns the
+    // number of keys newly reported.
+    uint32_t sweep(int64_t time, int64_t stuckThreshold) noexcept
+    {
+        uint32_t stuck = 0;
+        for (Key& key : keys_)
+        {
+            if (key.downTime != 0 && !key.isStuck && time - key.downTime > stuckThreshold)
+            {
+                key.isStuck = true;
+                ++stuck;
+            }
+        }
+        counts_.stuckKeys += stuck;
+        return stuck;
+    }
+
+    // Forgets the pressed keys, e.g. when key-ups can't be received any longer. The next key-up of each key isn't an
+    // orphan, as its key-down may have gone elsewhere, like the Alt of an Alt+Tab back.
+    void release() noexcept
+    {
+        keys_.fill({.downTime = 0, .isStuck = false, .isReleased = true});
+        pendingSequence_ = ScanCodeSequence::None;
+        afterE0Key_ = false;
+    }
+
+    void resetCounts() noexcept
+    {
+        counts_ = {};
+    }
+
+    [[nodiscard]] const Counts& counts() const noexcept
+    {
+        return counts_;
+    }
+
+private:
+    struct Key
+    {
+        int64_t downTime; // Zero if not pressed
+        bool isStuck;     // Reported for the current hold
+        bool isReleased;  // By release(), until the key's next event
+    };
+
+    std::array<Key, keyCount> keys_;
+    ScanCodeSequence pendingSequence_{ScanCodeSequence::None};
+    bool afterE0Key_{};
+    int64_t lastTime_{};
+    Counts counts_{};
+};
+
+// Streaming estimate of a device's report interval in constant memory. Intervals deviating from the running
+// baseline by more than outlierFactor are outliers, consecutive outliers form a burst. Gaps longer than
+// idleGap end a sequence of reports, e.g. when a mouse stops moving, and aren't counted as intervals.
+class PollingEstimator
+{
+public:
+    static constexpr double outlierFactor = 2.0;
+    static constexpr int64_t idleGapMilliseconds = 50;
+
+    void onReport(int64_t time) noexcept
+    {
+        const int64_t interval = time - lastTime_;
+        lastTime_ = time;
+        if (interval <= 0 || interval > PerformanceCounter::frequency() * idleGapMilliseconds / 1000)
+        {
+            currentBurst_ = 0;
+            return;
+        }
+
+        intervals_.record(PerformanceCounter::toNanoseconds(interval));
+
+        // Welford's online mean and variance
+        const double x = static_cast<double>(interval);
+        const double delta = x - mean_;
+        mean_ += delta / static_cast<double>(intervals_.count());
+        m2_ += delta * (x - mean_);
+
+        // The baseline is an exponentially weighted moving average, which follows changes of the polling rate
+        baseline_ = baseline_ == 0.0 ? x : baseline_ + (x - baseline_) / 16.0;
+        if (x > baseline_ * outlierFactor || x * outlierFactor < baseline_)
+        {
+            ++outliers_;
+            bursts_ += currentBurst_ == 0 ? 1 : 0;
+            longestBurst_ = std::max(longestBurst_, ++currentBurst_);
+        }
+        else
+        {
+            currentBurst_ = 0;
+        }
+    }
+
+    void reset() noexcept
+    {
+        intervals_.reset();
+        lastTime_ = 0; // The first report after a reset starts a new sequence
+        mean_ = 0.0;
+        m2_ = 0.0;
+        baseline_ = 0.0;
+        outliers_ = 0;
+        bursts_ = 0;
+        longestBurst_ = 0;
+        currentBurst_ = 0;
+    }
+
+    // Intervals in nanoseconds
+    [[nodiscard]] const Histogram<>& intervals() const noexcept
+    {
+        return intervals_;
+    }
+
+    // Reports per second, based on the median interval
+    [[nodiscard]] double rate() const noexcept
+    {
+        const uint64_t median = intervals_.valueAtPercentile(50.0);
+        return median != 0 ? 1e9 / static_cast<double>(median) : 0.0;
+    }
+
+    [[nodiscard]] double meanNanoseconds() const noexcept
+    {
+        return mean_ * 1e9 / static_cast<double>(PerformanceCounter::frequency());
+    }
+
+    [[nodiscard]] double standardDeviationNanoseconds() const noexcept
+    {
+        const uint64_t count = intervals_.count();
+        return count > 1 ? std::sqrt(m2_ / static_cast<double>(count - 1)) * 1e9 / static_cast<double>(PerformanceCounter::frequency()) : 0.0;
+    }
+
+    [[nodiscard]] uint64_t outliers() const noexcept
+    {
+        return outliers_;
+    }
+
+    [[nodiscard]] uint64_t bursts() const noexcept
+    {
+        return bursts_;
+    }
+
+    [[nodiscard]] uint64_t longestBurst() const noexcept
+    {
+        return longestBurst_;
+    }
+
+private:
+    Histogram<> intervals_;
+    int64_t lastTime_{};
+    double mean_{}; // Ticks
+    double m2_{};
+    double baseline_{};
+    uint64_t outliers_{};
+    uint64_t bursts_{};
+    uint64_t longestBurst_{};
+    uint64_t currentBurst_{};
+};
+
+// Converts absolute mouse events, as sent by pen tablets, remote desktop and virtual machines, into relative motion
+// in pixels with the kernels of AbsoluteMotion, so they show up in the mouse analyzers next to relative mice.
+class AbsoluteMouseNormalizer
+{
+public:
+    using Screen = AbsoluteMotion::Screen;
+
+    static constexpr int32_t absoluteMaximum = AbsoluteMotion::absoluteMaximum;
+    static_assert(AbsoluteMotion::flagMoveAbsolute == MOUSE_MOVE_ABSOLUTE && AbsoluteMotion::flagVirtualDesktop == MOUSE_VIRTUAL_DESKTOP);
+
+    [[nodiscard]] static Screen getScreen(bool virtualDesktop) noexcept
+    {
+        if (virtualDesktop)
+        {
+            return {GetSystemMetrics(SM_XVIRTUALSCREEN), GetSystemMetrics(SM_YVIRTUALSCREEN), GetSystemMetrics(SM_CXVIRTUALSCREEN), GetSystemMetrics(SM_CYVIRTUALSCREEN)};
+        }
+        return {0, 0, GetSystemMetrics(SM_CXSCREEN), GetSystemMetrics(SM_CYSCREEN)};
+    }
+
+    // Normalizes the events appended since the previous call into the store's motion columns
+    void normalize(MouseEventStore& store) noexcept
+    {
+        normalize(store, getScreen(false), getScreen(true));
+    }
+
+    void normalize(MouseEventStore& store, const Screen& primary, const Screen& desktop) noexcept
+    {
+        while (normalized_ < store.size())
+        {
+            const size_t c = normalized_ / store.dx.chunkSize;
+            const size_t first = normalized_ % store.dx.chunkSize;
+            const std::span<const int32_t> dx = std::as_const(store.dx).chunk(c);
+            const std::span<const int32_t> dy = std::as_const(store.dy).chunk(c);
+            const std::span<int32_t> motionX = store.motionX.chunk(c);
+            const std::span<int32_t> motionY = store.motionY.chunk(c);
+            const std::span<const USHORT> flags = std::as_const(store.flags).chunk(c);
+            const std::span<const uint8_t> devices = std::as_const(store.device).chunk(c);
+            AbsoluteMotion::toPixels(&dx[first], &dy[first], &flags[first], dx.size() - first, primary, desktop, &motionX[first], &motionY[first]);
+            motion_.toRelative(&motionX[first], &motionY[first], &flags[first], &devices[first], dx.size() - first);
+            normalized_ += dx.size() - first;
+        }
+    }
+
+    // Leaves the events appended since the previous call as they are, i.e. absolute events without motion
+    void skip(const MouseEventStore& store) noexcept
+    {
+        normalized_ = store.size();
+        motion_.reset();
+    }
+
+    void reset() noexcept
+    {
+        normalized_ = 0;
+        motion_.reset();
+    }
+
+    // Normalize the events appended so far first, or the device's pending events set its position again
+    void forget(uint8_t deviceIndex) noexcept
+    {
+        motion_.forget(deviceIndex);
+    }
+
+private:
+    size_t normalized_{};
+    AbsoluteMotion motion_;
+};
+
+// Streaming analysis of one wheel axis. High-resolution wheels report fractions of WHEEL_DELTA, which accumulate into
+// notches the way applications are expected to consume them; the remainder is carried to the next report.
+class WheelAxis
+{
+public:
+    static constexpr int64_t idleGapMilliseconds = 500; // Notches further apart belong to separate scrolls
+
+    void onDelta(SHORT delta, int64_t time) noexcept
+    {
+        if (delta == 0)
+        {
+            return;
+        }
+
+        ++events_;
+        total_ += delta;
+        fractionalEvents_ += delta % WHEEL_DELTA != 0 ? 1 : 0;
+        const int magnitude = std::abs(static_cast<int>(delta));
+        smallestStep_ = smallestStep_ == 0 ? magnitude : std::min(smallestStep_, magnitude);
+        granularity_ = std::gcd(granularity_, magnitude);
+
+        const int sign = delta < 0 ? -1 : 1;
+        reversals_ += lastSign_ != 0 && sign != lastSign_ ? 1 : 0;
+        lastSign_ = sign;
+
+        remainder_ += delta;
+        if (std::abs(remainder_) < WHEEL_DELTA)
+        {
+            return;
+        }
+
+        notches_ += static_cast<uint64_t>(std::abs(remainder_ / WHEEL_DELTA));
+        remainder_ %= WHEEL_DELTA;
+        const int64_t interval = time - lastNotchTime_;
+        lastNotchTime_ = time;
+        if (interval > 0 && interval <= PerformanceCounter::frequency() * idleGapMilliseconds / 1000)
+        {
+            notchIntervals_.record(PerformanceCounter::toNanoseconds(interval));
+        }
+    }
+
+    void reset() noexcept
+    {
+        notchIntervals_.reset();
+        lastNotchTime_ = 0;
+        events_ = 0;
+        fractionalEvents_ = 0;
+        notches_ = 0;
+        reversals_ = 0;
+        total_ = 0;
+        remainder_ = 0;
+        lastSign_ = 0;
+        smallestStep_ = 0;
+        granularity_ = 0;
+    }
+
+    // Reports per WHEEL_DELTA, i.e. 1 for a classic notched wheel
+    [[nodiscard]] int resolutionMultiplier() const noexcept
+    {
+        return granularity_ != 0 ? WHEEL_DELTA / std::gcd(granularity_, WHEEL_DELTA) : 0;
+    }
+
+    // Time between completed notches in nanoseconds
+    [[nodiscard]] const Histogram<>& notchIntervals() const noexcept
+    {
+        return notchIntervals_;
+    }
+
+    [[nodiscard]] uint64_t events() const noexcept
+    {
+        return events_;
+    }
+
+    [[nodiscard]] uint64_t fractionalEvents() const noexcept
+    {
+        return fractionalEvents_;
+    }
+
+    [[nodiscard]] uint64_t notches() const noexcept
+    {
+        return notches_;
+    }
+
+    [[nodiscard]] uint64_t reversals() const noexcept
+    {
+        return reversals_;
+    }
+
+    [[nodiscard]] int64_t total() const noexcept
+    {
+        return total_;
+    }
+
+    // Accumulated delta that hasn't completed a notch yet
+    [[nodiscard]] int remainder() const noexcept
+    {
+        return remainder_;
+    }
+
+    [[nodiscard]] int smallestStep() const noexcept
+    {
+        return smallestStep_;
+    }
+
+private:
+    Histogram<> notchIntervals_;
+    int64_t lastNotchTime_{};
+    uint64_t events_{};
+    uint64_t fractionalEvents_{};
+    uint64_t notches_{};
+    uint64_t reversals_{};
+    int64_t total_{};
+    int remainder_{};
+    int lastSign_{};
+    int smallestStep_{};
+    int granularity_{}; // Greatest common divisor of the deltas
+};
+
+struct WheelAnalyzer
+{
+    void onMouse(const RAWMOUSE& mouse, int64_t time) noexcept
+    {
+        if ((mouse.usButtonFlags & RI_MOUSE_WHEEL) != 0)
+        {
+            vertical.onDelta(static_cast<SHORT>(mouse.usButtonData), time);
+        }
+        else if ((mouse.usButtonFlags & RI_MOUSE_HWHEEL) != 0)
+        {
+            horizontal.onDelta(static_cast<SHORT>(mouse.usButtonData), time);
+        }
+    }
+
+    void reset() noexcept
+    {
+        vertical.reset();
+        horizontal.reset();
+    }
+
+    WheelAxis vertical;
+    WheelAxis horizontal;
+};
+
+// Movement of a single mouse. Raw mouse y points down, angles are counter-clockwise from +x with y pointing up.
+struct MouseMotion
+{
+    static constexpr size_t angleBins = 360;
+    static constexpr float minAxisAlignedLength = 2.0f; // Shorter moves are axis-aligned by nature
+
+    void reset() noexcept
+    {
+        pathLength = 0.0;
+        moves = 0;
+        longMoves = 0;
+        axisAligned = 0;
+        angles.fill(0);
+        velocity.reset();
+        acceleration.reset();
+    }
+
+    void merge(const MouseMotion& other) noexcept
+    {
+        pathLength += other.pathLength;
+        moves += other.moves;
+        longMoves += other.longMoves;
+        axisAligned += other.axisAligned;
+        for (size_t i = 0; i < angleBins; ++i)
+        {
+            angles[i] += other.angles[i];
+        }
+        velocity.merge(other.velocity);
+        acceleration.merge(other.acceleration);
+    }
+
+    double pathLength{}; // Counts
+    uint64_t moves{};
+    uint64_t longMoves{};   // Moves of at least minAxisAlignedLength counts
+    uint64_t axisAligned{}; // Long moves along a single axis; an excess hints at firmware angle snapping
+    std::array<uint64_t, angleBins> angles{}; // Bin n holds the angles in [n - 0.5, n + 0.5) degrees
+    Histogram<> velocity;     // Counts per second
+    Histogram<> acceleration; // Counts per second squared, absolute
+};
+
+// Computes the motion of one device over the mouse event store. Distances and directions are computed for four
+// events at a time with SSE2, velocity and acceleration depend on the device's previous move and are accumulated
+// in order. Runs of chunks are analyzed in parallel; each run's first moves have no predecessor and so no
+// velocity or acceleration, which is negligible with 65536 events per chunk.
+class MouseMotionAnalyzer
+{
+public:
+    static void analyze(const MouseEventStore& store, uint8_t deviceIndex, MouseMotion& motion)
+    {
+        const size_t chunkCount = store.time.chunkCount();
+        const size_t threadCount = std::clamp<size_t>(chunkCount, 1, std::max(std::thread::hardware_concurrency(), 1u));
+        std::vector<MouseMotionAnalyzer> analyzers(threadCount);
+        {
+            std::vector<std::jthread> threads;
+            threads.reserve(threadCount - 1);
+            for (size_t i = 1; i < threadCount; ++i)
+            {
+                threads.emplace_back([&, i] { analyzers[i].analyzeChunks(store, deviceIndex, chunkCount * i / threadCount, chunkCount * (i + 1) / threadCount); });
+            }
+            analyzers[0].analyzeChunks(store, deviceIndex, 0, chunkCount / threadCount);
+        }
+
+        for (const MouseMotionAnalyzer& analyzer : analyzers)
+        {
+            motion.merge(analyzer.motion_);
+        }
+    }
+
+    // Straight-line distance in counts of the device's last move with the left button held, e.g. a sweep along a
+    // ruler. Returns 0 if there was none.
+    [[nodiscard]] static double lastDragDistance(const MouseEventStore& store, uint8_t deviceIndex) noexcept
+    {
+        size_t end = store.size();
+        while (end > 0 && !(store.device[end - 1] == deviceIndex && (store.buttonFlags[end - 1] & RI_MOUSE_LEFT_BUTTON_UP) != 0))
+        {
+            --end;
+        }
+
+        int64_t x = 0;
+        int64_t y = 0;
+        for (size_t i = end; i-- > 0;)
+        {
+            if (store.device[i] == deviceIndex)
+            {
+                x += store.motionX[i];
+                y += store.motionY[i];
+                if ((store.buttonFlags[i] & RI_MOUSE_LEFT_BUTTON_DOWN) != 0)
+                {
+                    return std::hypot(static_cast<double>(x), static_cast<double>(y));
+                }
+            }
+        }
+        return 0.0;
+    }
+
+private:
+    void analyzeChunks(const MouseEventStore& store, uint8_t deviceIndex, size_t first, size_t last) noexcept
+    {
+        for (size_t c = first; c < last; ++c)
+        {
+            const std::span<const uint8_t> devices = store.device.chunk(c);
+            const std::span<const int32_t> dx = store.motionX.chunk(c);
+            const std::span<const int32_t> dy = store.motionY.chunk(c);
+            const std::span<const int64_t> time = store.time.chunk(c);
+
+            size_t i = 0;
+            for (; i + 4 <= devices.size(); i += 4)
+            {
+                analyzeBlock(&devices[i], &dx[i], &dy[i], &time[i], deviceIndex);
+            }
+
+            if (i < devices.size())
+            {
+                // Pad the last block with events of another device
+                std::array<uint8_t, 4> devicesBlock;
+                devicesBlock.fill(static_cast<uint8_t>(deviceIndex + 1));
+                std::array<int32_t, 4> dxBlock{};
+                std::array<int32_t, 4> dyBlock{};
+                std::array<int64_t, 4> timeBlock{};
+                const size_t count = devices.size() - i;
+                std::copy_n(&devices[i], count, devicesBlock.begin());
+                std::copy_n(&dx[i], count, dxBlock.begin());
+                std::copy_n(&dy[i], count, dyBlock.begin());
+                std::copy_n(&time[i], count, timeBlock.begin());
+                analyzeBlock(devicesBlock.data(), dxBlock.data(), dyBlock.data(), timeBlock.data(), deviceIndex);
+            }
+        }
+
+        const __m128d pathLength = _mm_add_pd(pathLength_, _mm_unpackhi_pd(pathLength_, pathLength_));
+        motion_.pathLength = _mm_cvtsd_f64(pathLength);
+    }
+
+    void analyzeBlock(const uint8_t* devices, const int32_t* dx, const int32_t* dy, const int64_t* time, uint8_t deviceIndex) noexcept
+    {
+        const __m128i zero = _mm_setzero_si128();
+
+        uint32_t deviceBytes;
+        std::memcpy(&deviceBytes, devices, sizeof(deviceBytes));
+        const __m128i device = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(deviceBytes)), zero), zero);
+        const __m128i isDevice = _mm_cmpeq_epi32(device, _mm_set1_epi32(deviceIndex));
+
+        const __m128i ix = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dx));
+        const __m128i iy = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dy));
+        const __m128i isXZero = _mm_cmpeq_epi32(ix, zero);
+        const __m128i isYZero = _mm_cmpeq_epi32(iy, zero);
+        const __m128 isMove = _mm_castsi128_ps(_mm_andnot_si128(_mm_and_si128(isXZero, isYZero), isDevice));
+        const int moveMask = _mm_movemask_ps(isMove);
+        if (moveMask == 0)
+        {
+            return;
+        }
+
+        const __m128 x = _mm_cvtepi32_ps(ix);
+        const __m128 y = _mm_cvtepi32_ps(iy);
+        const __m128 distance = _mm_and_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y))), isMove);
+        pathLength_ = _mm_add_pd(pathLength_, _mm_add_pd(_mm_cvtps_pd(distance), _mm_cvtps_pd(_mm_movehl_ps(distance, distance))));
+
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        const __m128 isLong = _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(_mm_and_ps(x, absMask), _mm_and_ps(y, absMask)), _mm_set1_ps(MouseMotion::minAxisAlignedLength)), isMove);
+        const __m128 isAxisAligned = _mm_and_ps(_mm_castsi128_ps(_mm_xor_si128(isXZero, isYZero)), isLong);
+        motion_.moves += std::popcount(static_cast<unsigned>(moveMask));
+        motion_.longMoves += std::popcount(static_cast<unsigned>(_mm_movemask_ps(isLong)));
+        motion_.axisAligned += std::popcount(static_cast<unsigned>(_mm_movemask_ps(isAxisAligned)));
+
+        // Bins are centered on whole degrees, so moves along an axis are in the middle of their bin
+        alignas(16) std::array<int32_t, 4> bins;
+        _mm_store_si128(reinterpret_cast<__m128i*>(bins.data()), _mm_cvtps_epi32(atan2Degrees(_mm_sub_ps(_mm_setzero_ps(), y), x)));
+        alignas(16) std::array<float, 4> distances;
+        _mm_store_ps(distances.data(), distance);
+
+        for (unsigned mask = static_cast<unsigned>(moveMask); mask != 0; mask &= mask - 1)
+        {
+            const int lane = std::countr_zero(mask);
+            ++motion_.angles[static_cast<size_t>(bins[lane]) % MouseMotion::angleBins];
+            addMove(distances[lane], time[lane]);
+        }
+    }
+
+    void addMove(float distance, int64_t time) noexcept
+    {
+        const int64_t interval = time - lastMoveTime_;
+        lastMoveTime_ = time;
+        if (interval <= 0 || interval > idleGap_)
+        {
+            lastVelocity_ = -1.0;
+            return;
+        }
+
+        const double seconds = static_cast<double>(interval) / static_cast<double>(frequency_);
+        const double velocity = static_cast<double>(distance) / seconds;
+        motion_.velocity.record(static_cast<uint64_t>(velocity));
+        if (lastVelocity_ >= 0.0)
+        {
+            motion_.acceleration.record(static_cast<uint64_t>(std::abs(velocity - lastVelocity_) / seconds));
+        }
+        lastVelocity_ = velocity;
+    }
+
+    // Polynomial approximation of atan2 (max. error 0.3 degrees), mapped to [0, 360)
+    [[nodiscard]] static __m128 atan2Degrees(__m128 y, __m128 x) noexcept
+    {
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        const __m128 absX = _mm_and_ps(x, absMask);
+        const __m128 absY = _mm_and_ps(y, absMask);
+        const __m128 a = _mm_div_ps(_mm_min_ps(absX, absY), _mm_max_ps(_mm_max_ps(absX, absY), _mm_set1_ps(1.0f)));
+        const __m128 s = _mm_mul_ps(a, a);
+        __m128 r = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-0.0464964749f), s), _mm_set1_ps(0.15931422f));
+        r = _mm_sub_ps(_mm_mul_ps(r, s), _mm_set1_ps(0.327622764f));
+        r = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(r, s), a), a);
+
+        auto select = [](__m128 mask, __m128 ifTrue, __m128 ifFalse) { return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse)); };
+        const __m128 pi = _mm_set1_ps(std::numbers::pi_v<float>);
+        r = select(_mm_cmpgt_ps(absY, absX), _mm_sub_ps(_mm_mul_ps(pi, _mm_set1_ps(0.5f)), r), r);
+        r = select(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(pi, r), r);
+        r = select(_mm_cmplt_ps(y, _mm_setzero_ps()), _mm_sub_ps(_mm_add_ps(pi, pi), r), r);
+        return _mm_mul_ps(r, _mm_set1_ps(180.0f / std::numbers::pi_v<float>));
+    }
+
+    // Taken per analysis, since recalibration may change the frequency
+    const int64_t frequency_{PerformanceCounter::frequency()};
+    const int64_t idleGap_{frequency_ * PollingEstimator::idleGapMilliseconds / 1000};
+    MouseMotion motion_;
+    __m128d pathLength_{_mm_setzero_pd()};
+    int64_t lastMoveTime_{};
+    double lastVelocity_{-1.0};
+};
+
+// Pointer acceleration curve as points of a piecewise-linear function of the input speed, which is the magnitude
+// of a mouse report in counts, i.e. max(|dx|, |dy|) + min(|dx|, |dy|) / 2, per report or per millisecond.
+// The last segment extends beyond the last point.
+struct BallisticsProfile
+{
+    enum class SpeedUnit
+    {
+        CountsPerReport,
+        CountsPerMillisecond
+    };
+
+    enum class Function
+    {
+        Gain,        // Values are pixels per count
+        OutputSpeed  // Values are output speeds in the same unit as the input, scaled by outputScale to pixels per count
+    };
+
+    static constexpr size_t maxPoints = 8;
+
+    SpeedUnit unit;
+    Function function;
+    double outputScale;
+    size_t pointCount;
+    std::array<double, maxPoints> speeds;
+    std::array<double, maxPoints> values;
+
+    // Cursor moves one pixel per count, e.g. Windows at the default pointer speed without "Enhance pointer precision"
+    static constexpr BallisticsProfile none() noexcept
+    {
+        return {.unit = SpeedUnit::CountsPerReport, .function = Function::Gain, .outputScale = 1.0, .pointCount = 1, .speeds = {0.0}, .values = {1.0}};
+    }
+
+    // Windows "Enhance pointer precision" with the default SmoothMouseXCurve/SmoothMouseYCurve points. Windows maps the
+    // magnitude to inches per second for a 400 DPI mouse polled at 125 Hz and the result to a 96 DPI screen.
+    static constexpr BallisticsProfile windowsEnhancePointerPrecision() noexcept
+    {
+        constexpr double inchesPerSecondPerCount = 125.0 / 400.0;
+        // clang-format off
+        return
+        {
+            .unit = SpeedUnit::CountsPerReport,
+            .function = Function::OutputSpeed,
+            .outputScale = 96.0 / 400.0,
+            .pointCount = 5,
+            .speeds = {0.0, 0.43 / inchesPerSecondPerCount, 1.25 / inchesPerSecondPerCount, 3.86 / inchesPerSecondPerCount, 40.0 / inchesPerSecondPerCount},
+            .values = {0.0, 1.37 / inchesPerSecondPerCount, 5.30 / inchesPerSecondPerCount, 24.30 / inchesPerSecondPerCount, 568.0 / inchesPerSecondPerCount}
+        };
+        // clang-format on
+    }
+
+    // The linear shape of libinput's adaptive profile at the default speed setting, for counts normalized to 1000 DPI:
+    // decelerated below 0.175 counts/ms, unaccelerated up to 0.4 counts/ms, then rising with an incline of 1.1 up to 2x.
+    static constexpr BallisticsProfile libinputAdaptive() noexcept
+    {
+        constexpr double threshold = 0.4;
+        constexpr double incline = 1.1;
+        constexpr double maxGain = 2.0;
+        // clang-format off
+        return
+        {
+            .unit = SpeedUnit::CountsPerMillisecond,
+            .function = Function::Gain,
+            .outputScale = 1.0,
+            .pointCount = 5,
+            .speeds = {0.0, 0.175, threshold, threshold + (maxGain - 1.0) / incline, threshold + (maxGain - 1.0) / incline + 1.0},
+            .values = {0.3, 1.0, 1.0, maxGain, maxGain}
+        };
+        // clang-format on
+    }
+};
+
+// Applies a pointer acceleration profile to raw mouse deltas. The profile is sampled into a 16.16 fixed-point gain
+// table; scaling the deltas by their gains runs on SSE2 in 32x32 to 64-bit fixed-point arithmetic. The cursor keeps
+// the sub-pixel remainder, so its position is the running sum of the scaled deltas.
+class PointerBallistics
+{
+public:
+    static constexpr size_t tableSize = 1024;
+    static constexpr int fractionBits = 16;
+
+    explicit PointerBallistics(const BallisticsProfile& profile) noexcept
+        : unit_{profile.unit}
+    {
+        // The table covers twice the last point's speed, beyond that the gain doesn't change
+        const double maxSpeed = std::max(profile.speeds[profile.pointCount - 1] * 2.0, 1.0);
+        step_ = static_cast<int64_t>(maxSpeed / tableSize * (1 << fractionBits)) + 1;
+        for (size_t i = 0; i < tableSize; ++i)
+        {
+            const double speed = static_cast<double>(step_ * static_cast<int64_t>(i)) / (1 << fractionBits);
+            gains_[i] = static_cast<uint32_t>(std::lround(gainAt(profile, speed) * (1 << fractionBits)));
+        }
+    }
+
+    // Fixed-point input speed of a report; interval is the time since the device's previous report in performance
+    // counter ticks, or zero if unknown
+    [[nodiscard]] uint32_t getSpeed(int32_t dx, int32_t dy, int64_t interval) const noexcept
+    {
+        const int64_t absX = std::abs(static_cast<int64_t>(dx));
+        const int64_t absY = std::abs(static_cast<int64_t>(dy));
+        double speed = static_cast<double>((std::max(absX, absY) + std::min(absX, absY) / 2) << fractionBits);
+        if (unit_ == BallisticsProfile::SpeedUnit::CountsPerMillisecond && interval > 0)
+        {
+            // In double, as a speed times a TSC frequency overflows 64 bits
+            speed = speed * static_cast<double>(PerformanceCounter::frequency()) / (static_cast<double>(interval) * 1000.0);
+        }
+        return static_cast<uint32_t>(std::min(speed, static_cast<double>(std::numeric_limits<uint32_t>::max())));
+    }
+
+    struct CursorPath
+    {
+        int32_t x;
+        int32_t y;
+        double length; // Pixels
+    };
+
+    // Moves the cursor by the device's relative motion in the store, from the current position
+    [[nodiscard]] CursorPath simulate(const MouseEventStore& store, uint8_t deviceIndex) noexcept
+    {
+        CursorPath path{static_cast<int32_t>(positionX_ >> fractionBits), static_cast<int32_t>(positionY_ >> fractionBits), 0.0};
+        Block block;
+        int64_t previousTime = 0;
+        for (size_t c = 0; c < store.device.chunkCount(); ++c)
+        {
+            const std::span<const uint8_t> devices = store.device.chunk(c);
+            const std::span<const USHORT> flags = store.flags.chunk(c);
+            const std::span<const int32_t> dx = store.dx.chunk(c);
+            const std::span<const int32_t> dy = store.dy.chunk(c);
+            const std::span<const int64_t> time = store.time.chunk(c);
+            for (size_t i = 0; i < devices.size(); ++i)
+            {
+                if (devices[i] != deviceIndex)
+                {
+                    continue;
+                }
+
+                // Windows doesn't accelerate absolute input, so only raw relative counts are simulated
+                const int64_t interval = previousTime != 0 ? time[i] - previousTime : 0;
+                previousTime = time[i];
+                if ((flags[i] & MOUSE_MOVE_ABSOLUTE) != 0 || (dx[i] == 0 && dy[i] == 0))
+                {
+                    continue;
+                }
+
+                block.dx[block.count] = dx[i];
+                block.dy[block.count] = dy[i];
+                block.speeds[block.count] = getSpeed(dx[i], dy[i], interval);
+                if (++block.count == block.dx.size())
+                {
+                    flush(block, path);
+                }
+            }
+        }
+        flush(block, path);
+        return path;
+    }
+
+    // Moves the cursor by count deltas with the given speeds and writes the resulting positions in pixels
+    void simulate(const int32_t* dx, const int32_t* dy, const uint32_t* speeds, size_t count, int32_t* x, int32_t* y) noexcept
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            alignas(16) std::array<uint32_t, 4> gains;
+            for (size_t lane = 0; lane < 4; ++lane)
+            {
+                gains[lane] = gains_[std::min<size_t>(speeds[i + lane] / step_, tableSize - 1)];
+            }
+            const __m128i gain = _mm_load_si128(reinterpret_cast<const __m128i*>(gains.data()));
+
+            alignas(16) std::array<int64_t, 4> scaledX;
+            alignas(16) std::array<int64_t, 4> scaledY;
+            scale(_mm_loadu_si128(reinterpret_cast<const __m128i*>(dx + i)), gain, scaledX.data());
+            scale(_mm_loadu_si128(reinterpret_cast<const __m128i*>(dy + i)), gain, scaledY.data());
+            for (size_t lane = 0; lane < 4; ++lane)
+            {
+                x[i + lane] = move(positionX_, scaledX[lane]);
+                y[i + lane] = move(positionY_, scaledY[lane]);
+            }
+        }
+
+        for (; i < count; ++i)
+        {
+            const int64_t gain = gains_[std::min<size_t>(speeds[i] / step_, tableSize - 1)];
+            x[i] = move(positionX_, dx[i] * gain);
+            y[i] = move(positionY_, dy[i] * gain);
+        }
+    }
+
+private:
+    struct Block
+    {
+        static constexpr size_t capacity = 256;
+
+        size_t count{};
+        std::array<int32_t, capacity> dx;
+        std::array<int32_t, capacity> dy;
+        std::array<uint32_t, capacity> speeds;
+        std::array<int32_t, capacity> x;
+        std::array<int32_t, capacity> y;
+    };
+
+    void flush(Block& block, CursorPath& path) noexcept
+    {
+        simulate(block.dx.data(), block.dy.data(), block.speeds.data(), block.count, block.x.data(), block.y.data());
+        for (size_t i = 0; i < block.count; ++i)
+        {
+            path.length += std::hypot(static_cast<double>(block.x[i] - path.x), static_cast<double>(block.y[i] - path.y));
+            path.x = block.x[i];
+            path.y = block.y[i];
+        }
+        block.count = 0;
+    }
+
+    [[nodiscard]] static double gainAt(const BallisticsProfile& profile, double speed) noexcept
+    {
+        size_t segment = 1;
+        while (segment + 1 < profile.pointCount && speed > profile.speeds[segment])
+        {
+            ++segment;
+        }
+
+        double value = profile.values[0];
+        if (profile.pointCount > 1)
+        {
+            const double x0 = profile.speeds[segment - 1];
+            const double x1 = profile.speeds[segment];
+            value = profile.values[segment - 1] + (speed - x0) * (profile.values[segment] - profile.values[segment - 1]) / (x1 - x0);
+        }
+
+        if (profile.function == BallisticsProfile::Function::Gain)
+        {
+            return std::max(value, 0.0) * profile.outputScale;
+        }
+
+        // Gain is output speed over input speed, which at zero speed is the slope of the first segment
+        const double gain = speed > 0.0 ? value / speed : (profile.pointCount > 1 ? profile.values[1] / profile.speeds[1] : 0.0);
+        return std::max(gain, 0.0) * profile.outputScale;
+    }
+
+    // Multiplies signed deltas by unsigned 16.16 gains into 64-bit 16.16 results. SSE2 only multiplies unsigned 32-bit
+    // lanes 0 and 2 into 64 bits, so magnitudes are multiplied in two passes and the signs restored afterwards.
+    static void scale(__m128i delta, __m128i gain, int64_t* scaled) noexcept
+    {
+        const __m128i sign = _mm_srai_epi32(delta, 31);
+        const __m128i magnitude = _mm_sub_epi32(_mm_xor_si128(delta, sign), sign);
+        const __m128i even = _mm_mul_epu32(magnitude, gain);
+        const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(magnitude, 32), _mm_srli_epi64(gain, 32));
+
+        // Widen the 32-bit sign masks to 64 bits and apply them
+        const __m128i evenSign = _mm_shuffle_epi32(sign, _MM_SHUFFLE(2, 2, 0, 0));
+        const __m128i oddSign = _mm_shuffle_epi32(sign, _MM_SHUFFLE(3, 3, 1, 1));
+        const __m128i signedEven = _mm_sub_epi64(_mm_xor_si128(even, evenSign), evenSign);
+        const __m128i signedOdd = _mm_sub_epi64(_mm_xor_si128(odd, oddSign), oddSign);
+        _mm_store_si128(reinterpret_cast<__m128i*>(scaled), _mm_unpacklo_epi64(signedEven, signedOdd));
+        _mm_store_si128(reinterpret_cast<__m128i*>(scaled + 2), _mm_unpackhi_epi64(signedEven, signedOdd));
+    }
+
+    [[nodiscard]] static int32_t move(int64_t& position, int64_t delta) noexcept
+    {
+        position += delta;
+        return static_cast<int32_t>(position >> fractionBits);
+    }
+
+    std::array<uint32_t, tableSize> gains_;
+    int64_t step_;
+    int64_t positionX_{};
+    int64_t positionY_{};
+    BallisticsProfile::SpeedUnit unit_;
+};
+
+// Raw HID reports in an arena of fixed-size blocks. A report never straddles blocks, so it can be handed out as a
+// span, and clear() keeps the blocks, so refilling doesn't allocate.
+class HidReportStore
+{
+public:
+    static constexpr size_t blockSize = 65536; // Also the largest report kept in full
+
+    // Empty reports are dropped, a report has at least one byte and its length is stored minus one
+    void append(uint8_t deviceIndex, std::span<const uint8_t> report, int64_t timestamp)
+    {
+        if (report.empty())
+        {
+            return;
+        }
+
+        const size_t size = std::min(report.size(), blockSize);
+        if (blockCount_ == 0 || blockUsed_ + size > blockSize)
+        {
+            if (blockCount_ == blocks_.size())
+            {
+                blocks_.push_back(std::make_unique_for_overwrite<uint8_t[]>(blockSize));
+            }
+            ++blockCount_;
+            blockUsed_ = 0;
+        }
+
+        std::memcpy(blocks_[blockCount_ - 1].get() + blockUsed_, report.data(), size);
+        offset.push_back((blockCount_ - 1) * blockSize + blockUsed_);
+        length.push_back(static_cast<uint16_t>(size - 1)); // Up to 65536 bytes
+        device.push_back(deviceIndex);
+        time.push_back(timestamp);
+        blockUsed_ += size;
+    }
+
+    [[nodiscard]] std::span<const uint8_t> report(size_t index) const noexcept
+    {
+        const size_t start = offset[index];
+        return {blocks_[start / blockSize].get() + start % blockSize, size_t{length[index]} + 1};
+    }
+
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return time.size();
+    }
+
+    void clear() noexcept
+    {
+        offset.clear();
+        length.clear();
+        device.clear();
+        time.clear();
+        blockCount_ = 0;
+        blockUsed_ = 0;
+    }
+
+    ChunkedColumn<uint64_t> offset; // Into the arena
+    ChunkedColumn<uint16_t> length; // Bytes minus one
+    ChunkedColumn<uint8_t> device; // DeviceRegistry index
+    ChunkedColumn<int64_t> time;
+
+private:
+    std::vector<std::unique_ptr<uint8_t[]>> blocks_;
+    size_t blockCount_{}; // In use
+    size_t blockUsed_{};
+};
+
+// Windows doesn't hand out report descriptors, so the extraction plan is compiled by probing the preparsed data:
+// every input usage is set to all ones in an otherwise empty report, and the bits that changed are its field.
+// Array fields can't be located this way and are left out.
+[[nodiscard]] inline HidExtractionPlan compileHidExtractionPlan(HANDLE hDevice)
+{
+    UINT size = 0;
+    if (GetRawInputDeviceInfoW(hDevice, RIDI_PREPARSEDDATA, nullptr, &size) != 0 || size == 0)
+    {
+        return {};
+    }
+
+    TempBuffer<uint8_t> buffer(size);
+    if (GetRawInputDeviceInfoW(hDevice, RIDI_PREPARSEDDATA, buffer.data(), &size) == static_cast<UINT>(-1))
+    {
+        return {};
+    }
+
+    const PHIDP_PREPARSED_DATA preparsed = reinterpret_cast<PHIDP_PREPARSED_DATA>(buffer.data());
+    HIDP_CAPS caps{};
+    if (HidP_GetCaps(preparsed, &caps) != HIDP_STATUS_SUCCESS || caps.InputReportByteLength == 0)
+    {
+        return {};
+    }
+
+    std::vector<HIDP_BUTTON_CAPS> buttonCaps(caps.NumberInputButtonCaps);
+    USHORT buttonCapCount = caps.NumberInputButtonCaps;
+    if (buttonCapCount != 0 && HidP_GetButtonCaps(HidP_Input, buttonCaps.data(), &buttonCapCount, preparsed) != HIDP_STATUS_SUCCESS)
+    {
+        buttonCapCount = 0;
+    }
+
+    std::vector<HIDP_VALUE_CAPS> valueCaps(caps.NumberInputValueCaps);
+    USHORT valueCapCount = caps.NumberInputValueCaps;
+    if (valueCapCount != 0 && HidP_GetValueCaps(HidP_Input, valueCaps.data(), &valueCapCount, preparsed) != HIDP_STATUS_SUCCESS)
+    {
+        valueCapCount = 0;
+    }
+
+    const ULONG reportLength = caps.InputReportByteLength;
+    std::vector<char> empty(reportLength);
+    std::vector<char> probe(reportLength);
+    std::vector<HidField> fields;
+
+    // Stores the changed bits in the field; fails if none changed or they span more than 32 bits
+    auto locate = [&](HidField& field)
+    {
+        size_t first = reportLength * 8;
+        size_t last = 0;
+        for (size_t bit = 0; bit < reportLength * 8; ++bit)
+        {
+            if (((empty[bit / 8] ^ probe[bit / 8]) >> (bit % 8)) & 1)
+            {
+                first = std::min(first, bit);
+                last = bit;
+            }
+        }
+
+        if (first > last || last - first >= 32)
+        {
+            return false;
+        }
+        field.bitOffset = static_cast<uint32_t>(first);
+        field.bitSize = static_cast<uint8_t>(last - first + 1);
+        return true;
+    };
+
+    for (const HIDP_BUTTON_CAPS& cap : std::span(buttonCaps).first(buttonCapCount))
+    {
+        const USAGE minimum = cap.IsRange ? cap.Range.UsageMin : cap.NotRange.Usage;
+        const USAGE maximum = cap.IsRange ? cap.Range.UsageMax : cap.NotRange.Usage;
+        for (uint32_t usage = minimum; usage <= maximum && fields.size() < HidExtractionPlan::maxFields; ++usage)
+        {
+            HidP_InitializeReportForID(HidP_Input, cap.ReportID, preparsed, empty.data(), reportLength);
+            probe = empty;
+            USAGE usages[] = {static_cast<USAGE>(usage)};
+            ULONG usageCount = 1;
+            if (HidP_SetUsages(HidP_Input, cap.UsagePage, cap.LinkCollection, usages, &usageCount, preparsed, probe.data(), reportLength) != HIDP_STATUS_SUCCESS)
+            {
+                continue;
+            }
+
+            HidField field{.usagePage = cap.UsagePage, .usage = static_cast<uint16_t>(usage), .reportId = cap.ReportID, .logicalMinimum = 0, .logicalMaximum = 1};
+            if (locate(field) && field.bitSize == 1)
+            {
+                fields.push_back(field);
+            }
+        }
+    }
+
+    for (const HIDP_VALUE_CAPS& cap : std::span(valueCaps).first(valueCapCount))
+    {
+        const USAGE minimum = cap.IsRange ? cap.Range.UsageMin : cap.NotRange.Usage;
+        const USAGE maximum = cap.IsRange ? cap.Range.UsageMax : cap.NotRange.Usage;
+        const ULONG allOnes = cap.BitSize < 32 ? (1ul << cap.BitSize) - 1 : ~0ul;
+        for (uint32_t usage = minimum; usage <= maximum && fields.size() < HidExtractionPlan::maxFields; ++usage)
+        {
+            HidP_InitializeReportForID(HidP_Input, cap.ReportID, preparsed, empty.data(), reportLength);
+            probe = empty;
+            if (HidP_SetUsageValue(HidP_Input, cap.UsagePage, cap.LinkCollection, static_cast<USAGE>(usage), 0, preparsed, empty.data(), reportLength) != HIDP_STATUS_SUCCESS ||
+                HidP_SetUsageValue(HidP_Input, cap.UsagePage, cap.LinkCollection, static_cast<USAGE>(usage), allOnes, preparsed, probe.data(), reportLength) != HIDP_STATUS_SUCCESS)
+            {
+                continue;
+            }
+
+            HidField field{.usagePage = cap.UsagePage, .usage = static_cast<uint16_t>(usage), .reportId = cap.ReportID, .logicalMinimum = cap.LogicalMin, .logicalMaximum = cap.LogicalMax};
+            if (locate(field))
+            {
+                fields.push_back(field);
+            }
+        }
+    }
+
+    return HidExtractionPlan(std::move(fields));
+}
+
+enum class DeviceChange : uint8_t
+{
+    Arrival,
+    Removal
+};
+
+// Device arrivals and removals in the order of WM_INPUT_DEVICE_CHANGE messages
+struct DeviceChangeStore
+{
+    void append(uint8_t deviceIndex, DeviceChange change, int64_t timestamp)
+    {
+        device.push_back(deviceIndex);
+        changes.push_back(change);
+        time.push_back(timestamp);
+    }
+
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return time.size();
+    }
+
+    void clear() noexcept
+    {
+        device.clear();
+        changes.clear();
+        time.clear();
+    }
+
+    ChunkedColumn<uint8_t, 1024> device; // DeviceRegistry index
+    ChunkedColumn<DeviceChange, 1024> changes;
+    ChunkedColumn<int64_t, 1024> time;
+};
+
+// Metadata of the input devices seen so far. Events refer to devices by their registry index, which fits a byte.
+// The ingest thread only pays for a lookup in a small table; names, IDs, and HID capabilities are resolved on a
+// worker thread when a device is registered and again when its handle returns after a removal. Once all slots are
+// taken, a new device takes over the slot of a removed one, so older events of that slot show the new device.
+class DeviceRegistry
+{
+public:
+    static constexpr size_t capacity = 256; // Devices beyond, with all slots connected, share the last index
+    static_assert(capacity <= DeviceTable<int>::capacity, "Registry indexes must fit the per-device tables");
+
+    struct Info
+    {
+        std::wstring name; // Device interface path
+        DWORD type{};
+        DWORD vendorId{};
+        DWORD productId{};
+        USHORT usagePage{};
+        USHORT usage{};
+        USHORT inputReportLength{}; // HID only, just like the following members
+        USHORT buttonCaps{};
+        USHORT valueCaps{};
+        HidExtractionPlan plan;
+    };
+
+    DeviceRegistry(const DeviceRegistry&) = delete;
+    DeviceRegistry& operator=(const DeviceRegistry&) = delete;
+
+    DeviceRegistry()
+        : resolver_{[this](std::stop_token stopToken) { resolve(stopToken); }}
+    {
+    }
+
+    // Only the ingest thread registers devices. isAssigned tells whether the index was given to the device just now,
+    // possibly taking over a removed device's slot, so per-device state kept elsewhere can start over.
+    [[nodiscard]] uint8_t getIndex(HANDLE hDevice, bool& isAssigned)
+    {
+        isAssigned = false;
+        const size_t count = count_.load(std::memory_order_relaxed);
+        if (last_ < count && handles_[last_] == hDevice)
+        {
+            return static_cast<uint8_t>(last_);
+        }
+
+        if (const std::optional<uint8_t> index = findIndex(hDevice))
+        {
+            last_ = *index;
+            return *index;
+        }
+
+        size_t index = count;
+        if (count == capacity)
+        {
+            index = static_cast<size_t>(std::ranges::find(disconnected_, true) - disconnected_.begin());
+            if (index == capacity)
+            {
+                return static_cast<uint8_t>(capacity - 1);
+            }
+        }
+
+        assign(index, hDevice);
+        last_ = index;
+        isAssigned = true;
+        return static_cast<uint8_t>(index);
+    }
+
+    // Doesn't register the device
+    [[nodiscard]] std::optional<uint8_t> findIndex(HANDLE hDevice) const noexcept
+    {
+        const size_t count = count_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (handles_[i] == hDevice)
+            {
+                return static_cast<uint8_t>(i);
+            }
+        }
+        return std::nullopt;
+    }
+
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return count_.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] HANDLE getHandle(uint8_t index) const noexcept
+    {
+        _ASSERT(index < size());
+        return handles_[index];
+    }
+
+    // Devices are connected from their first event or arrival until their removal. A handle coming back may belong
+    // to another device, so its metadata is resolved again.
+    void setConnected(uint8_t index, bool connected)
+    {
+        if (connected && disconnected_[index])
+        {
+            assign(index, handles_[index]);
+        }
+        disconnected_[index] = !connected;
+    }
+
+    [[nodiscard]] bool isConnected(uint8_t index) const noexcept
+    {
+        return !disconnected_[index];
+    }
+
+    // Null until the device is resolved
+    [[nodiscard]] const Info* find(uint8_t index) const noexcept
+    {
+        return index < size() && resolved_[index].load(std::memory_order_acquire) ? &infos_[index] : nullptr;
+    }
+
+    [[nodiscard]] static Info query(HANDLE hDevice)
+    {
+        Info info;
+        UINT size = 0;
+        if (GetRawInputDeviceInfoW(hDevice, RIDI_DEVICENAME, nullptr, &size) == 0 && size != 0)
+        {
+            info.name.resize(size);
+            const UINT copied = GetRawInputDeviceInfoW(hDevice, RIDI_DEVICENAME, info.name.data(), &size);
+            info.name.resize(copied != static_cast<UINT>(-1) ? std::wcslen(info.name.c_str()) : 0);
+        }
+
+        RID_DEVICE_INFO deviceInfo{.cbSize = sizeof(RID_DEVICE_INFO)};
+        size = sizeof(deviceInfo);
+        if (GetRawInputDeviceInfoW(hDevice, RIDI_DEVICEINFO, &deviceInfo, &size) != static_cast<UINT>(-1))
+        {
+            info.type = deviceInfo.dwType;
+        }
+
+        if (info.type == RIM_TYPEHID)
+        {
+            info.vendorId = deviceInfo.hid.dwVendorId;
+            info.productId = deviceInfo.hid.dwProductId;
+            info.usagePage = deviceInfo.hid.usUsagePage;
+            info.usage = deviceInfo.hid.usUsage;
+            queryHidCaps(hDevice, info);
+            info.plan = compileHidExtractionPlan(hDevice);
+        }
+        else
+        {
+            // Keyboards and mice only reveal their IDs in the interface path, e.g. \\?\HID#VID_046D&PID_C52B&...
+            info.vendorId = parseHexAfter(info.name, L"VID_");
+            info.productId = parseHexAfter(info.name, L"PID_");
+            info.usagePage = 0x01;
+            info.usage = info.type == RIM_TYPEKEYBOARD ? 0x06 : 0x02;
+        }
+        return info;
+    }
+
+private:
+    // (Re)assigns a slot and queues it for resolution
+    void assign(size_t index, HANDLE hDevice)
+    {
+        resolved_[index].store(false, std::memory_order_relaxed);
+        disconnected_[index] = false;
+        {
+            // Writing under the lock keeps the resolver from reading a handle being replaced or missing the notification
+            std::lock_guard lock(mutex_);
+            handles_[index] = hDevice;
+            pending_.set(index);
+            count_.store(std::max(count_.load(std::memory_order_relaxed), index + 1), std::memory_order_release);
+        }
+        resolveRequested_.notify_one();
+    }
+
+    void resolve(std::stop_token stopToken)
+    {
+        std::unique_lock lock(mutex_);
+        while (resolveRequested_.wait(lock, stopToken, [&] { return pending_.any(); }))
+        {
+            for (size_t i = 0; i < capacity; ++i)
+            {
+                if (!pending_[i])
+                {
+                    continue;
+                }
+
+                pending_.reset(i);
+                const HANDLE hDevice = handles_[i];
+                lock.unlock();
+                Info info = query(hDevice);
+                lock.lock();
+
+                // Unless the slot was reassigned meanwhile, which queued it again
+                if (!pending_[i])
+                {
+                    infos_[i] = std::move(info);
+                    resolved_[i].store(true, std::memory_order_release);
+                }
+            }
+        }
+    }
+
+    static void queryHidCaps(HANDLE hDevice, Info& info)
+    {
+        UINT size = 0;
+        if (GetRawInputDeviceInfoW(hDevice, RIDI_PREPARSEDDATA, nullptr, &size) != 0 || size == 0)
+        {
+            return;
+        }
+
+        TempBuffer<uint8_t> buffer(size);
+        HIDP_CAPS caps{};
+        if (GetRawInputDeviceInfoW(hDevice, RIDI_PREPARSEDDATA, buffer.data(), &size) != static_cast<UINT>(-1) &&
+            HidP_GetCaps(reinterpret_cast<PHIDP_PREPARSED_DATA>(buffer.data()), &caps) == HIDP_STATUS_SUCCESS)
+        {
+            info.inputReportLength = caps.InputReportByteLength;
+            info.buttonCaps = caps.NumberInputButtonCaps;
+            info.valueCaps = caps.NumberInputValueCaps;
+        }
+    }
+
+    [[nodiscard]] static DWORD parseHexAfter(const std::wstring& text, std::wstring_view prefix) noexcept
+    {
+        const size_t position = text.find(prefix);
+        return position != std::wstring::npos ? static_cast<DWORD>(std::wcstoul(text.c_str() + position + prefix.size(), nullptr, 16)) : 0;
+    }
+
+    std::array<HANDLE, capacity> handles_{};
+    std::array<Info, capacity> infos_;
+    std::array<std::atomic<bool>, capacity> resolved_{};
+    std::array<bool, capacity> disconnected_{};
+    std::bitset<capacity> pending_; // Slots to resolve, guarded by mutex_
+    std::atomic<size_t> count_{};
+    size_t last_{}; // Most recent device, as events tend to come in runs
+    std::mutex mutex_;
+    std::condition_variable_any resolveRequested_;
+    std::jthread resolver_; // Last, so it stops before the members it uses are destroyed
+};
+
+// Streaming statistics of one gamepad axis, fed with decoded values in batches. Memory doesn't depend on the capture
+// length: distinct values go into a bitmap and noise and intervals into histograms. An axis rests while it stays
+// within restingFraction of its half range around the center, which is where noise and drift show.
+class GamepadAxisAnalyzer
+{
+public:
+    static constexpr double restingFraction = 0.2;
+    static constexpr size_t distinctBits = 65536; // Exact for axes of up to 16 bits, a linear counting sketch beyond
+
+    // Generic Desktop X, Y, Z, Rx, Ry, Rz, Slider and Dial
+    [[nodiscard]] static bool isAxis(const HidField& field) noexcept
+    {
+        return field.usagePage == 0x01 && field.usage >= 0x30 && field.usage <= 0x37 && !field.isArray && field.bitSize > 1;
+    }
+
+    explicit GamepadAxisAnalyzer(const HidField& field) noexcept
+        : field_{field}
+        , center_{(static_cast<int64_t>(field.logicalMinimum) + field.logicalMaximum) / 2}
+        , restingThreshold_{std::max<int64_t>(static_cast<int64_t>(restingFraction * static_cast<double>(static_cast<int64_t>(field.logicalMaximum) - field.logicalMinimum) / 2.0), 1)}
+    {
+    }
+
+    // Values and the performance counter times of their reports
+    void analyze(std::span<const int32_t> values, std::span<const int64_t> times) noexcept
+    {
+        _ASSERT(values.size() == times.size());
+        if (values.empty())
+        {
+            return;
+        }
+
+        const Sums sums = reduce(values);
+        count_ += values.size();
+        restingCount_ += sums.restingCount;
+        restingSum_ += sums.restingSum;
+        restingSquares_ += sums.restingSquares;
+        minimum_ = std::min(minimum_, sums.minimum);
+        maximum_ = std::max(maximum_, sums.maximum);
+
+        // Drift is the least-squares slope of the batches' resting means over time
+        if (sums.restingCount != 0)
+        {
+            if (firstTime_ == 0)
+            {
+                firstTime_ = times[0];
+            }
+            const double t = static_cast<double>(PerformanceCounter::toNanoseconds((times.front() + times.back()) / 2 - firstTime_)) / 1e9;
+            const double mean = static_cast<double>(sums.restingSum) / static_cast<double>(sums.restingCount);
+            const double weight = static_cast<double>(sums.restingCount);
+            driftWeight_ += weight;
+            driftT_ += weight * t;
+            driftV_ += weight * mean;
+            driftTT_ += weight * t * t;
+            driftTV_ += weight * t * mean;
+        }
+
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            const uint32_t bit = static_cast<uint32_t>(static_cast<int64_t>(values[i]) - field_.logicalMinimum) % distinctBits;
+            distinct_[bit / 64] |= uint64_t{1} << (bit % 64);
+
+            if (lastTime_ != 0 && times[i] > lastTime_)
+            {
+                intervals_.record(PerformanceCounter::toNanoseconds(times[i] - lastTime_));
+            }
+            lastTime_ = times[i];
+
+            const int64_t deviation = values[i] - center_;
+            if (std::abs(deviation) <= restingThreshold_)
+            {
+                offsets_.record(static_cast<uint64_t>(std::abs(deviation)));
+                if (lastResting_)
+                {
+                    jitter_.record(static_cast<uint64_t>(std::abs(values[i] - lastValue_)));
+                }
+                lastResting_ = true;
+            }
+            else
+            {
+                lastResting_ = false;
+            }
+            lastValue_ = values[i];
+        }
+    }
+
+    [[nodiscard]] const HidField& field() const noexcept
+    {
+        return field_;
+    }
+
+    [[nodiscard]] uint64_t count() const noexcept
+    {
+        return count_;
+    }
+
+    [[nodiscard]] uint64_t restingCount() const noexcept
+    {
+        return restingCount_;
+    }
+
+    // Number of distinct values seen
+    [[nodiscard]] double distinctValues() const noexcept
+    {
+        const size_t set = std::accumulate(distinct_.begin(), distinct_.end(), size_t{0}, [](size_t sum, uint64_t word) { return sum + static_cast<size_t>(std::popcount(word)); });
+        if (static_cast<uint64_t>(static_cast<int64_t>(field_.logicalMaximum) - field_.logicalMinimum) < distinctBits || set == distinctBits)
+        {
+            return static_cast<double>(set);
+        }
+
+        // Linear counting estimate for axes with more values than bits
+        return -static_cast<double>(distinctBits) * std::log(static_cast<double>(distinctBits - set) / static_cast<double>(distinctBits));
+    }
+
+    // Mean resting position relative to the center
+    [[nodiscard]] double restingOffset() const noexcept
+    {
+        return restingCount_ != 0 ? static_cast<double>(restingSum_) / static_cast<double>(restingCount_) : 0.0;
+    }
+
+    // Standard deviation of the resting position
+    [[nodiscard]] double restingNoise() const noexcept
+    {
+        if (restingCount_ < 2)
+        {
+            return 0.0;
+        }
+        const double mean = restingOffset();
+        return std::sqrt(std::max(static_cast<double>(restingSquares_) / static_cast<double>(restingCount_) - mean * mean, 0.0));
+    }
+
+    // Change of the resting position in values per second
+    [[nodiscard]] double drift() const noexcept
+    {
+        const double denominator = driftWeight_ * driftTT_ - driftT_ * driftT_;
+        return denominator > 1e-12 ? (driftWeight_ * driftTV_ - driftT_ * driftV_) / denominator : 0.0;
+    }
+
+    [[nodiscard]] int32_t minimum() const noexcept
+    {
+        return minimum_;
+    }
+
+    [[nodiscard]] int32_t maximum() const noexcept
+    {
+        return maximum_;
+    }
+
+    // Distance of resting values from the center
+    [[nodiscard]] const Histogram<>& offsets() const noexcept
+    {
+        return offsets_;
+    }
+
+    // Change between consecutive resting values
+    [[nodiscard]] const Histogram<>& jitter() const noexcept
+    {
+        return jitter_;
+    }
+
+    // Time between reports carrying the axis in nanoseconds
+    [[nodiscard]] const Histogram<>& intervals() const noexcept
+    {
+        return intervals_;
+    }
+
+    // Half range of the axis, e.g. to express offsets as a share of full deflection
+    [[nodiscard]] double halfRange() const noexcept
+    {
+        return static_cast<double>(static_cast<int64_t>(field_.logicalMaximum) - field_.logicalMinimum) / 2.0;
+    }
+
+private:
+    struct Sums
+    {
+        uint64_t restingCount;
+        int64_t restingSum;      // Of deviations from the center
+        uint64_t restingSquares; // Of deviations from the center
+        int32_t minimum;
+        int32_t maximum;
+    };
+
+    // SSE2 reduction of a batch; deviations are kept in 64-bit lanes so that 32-bit axes can't overflow
+    [[nodiscard]] Sums reduce(std::span<const int32_t> values) const noexcept
+    {
+        const int32_t center = static_cast<int32_t>(center_);
+        const __m128i center4 = _mm_set1_epi32(center);
+        const __m128i threshold4 = _mm_set1_epi32(static_cast<int32_t>(std::min<int64_t>(restingThreshold_, std::numeric_limits<int32_t>::max() - 1) + 1));
+        __m128i minimum4 = _mm_set1_epi32(std::numeric_limits<int32_t>::max());
+        __m128i maximum4 = _mm_set1_epi32(std::numeric_limits<int32_t>::min());
+        __m128i count4 = _mm_setzero_si128();
+        __m128i sum2 = _mm_setzero_si128();
+        __m128i squares2 = _mm_setzero_si128();
+
+        size_t i = 0;
+        for (; i + 4 <= values.size(); i += 4)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&values[i]));
+            const __m128i lower = _mm_cmplt_epi32(v, minimum4);
+            minimum4 = _mm_or_si128(_mm_and_si128(lower, v), _mm_andnot_si128(lower, minimum4));
+            const __m128i higher = _mm_cmpgt_epi32(v, maximum4);
+            maximum4 = _mm_or_si128(_mm_and_si128(higher, v), _mm_andnot_si128(higher, maximum4));
+
+            // Resting deviations are within the threshold, so they fit 32 bits
+            const __m128i deviation = _mm_sub_epi32(v, center4);
+            const __m128i sign = _mm_srai_epi32(deviation, 31);
+            const __m128i magnitude = _mm_sub_epi32(_mm_xor_si128(deviation, sign), sign);
+            // A negative magnitude means the deviation overflowed, which is anything but resting
+            const __m128i resting = _mm_andnot_si128(_mm_srai_epi32(magnitude, 31), _mm_cmplt_epi32(magnitude, threshold4));
+            count4 = _mm_sub_epi32(count4, resting);
+
+            const __m128i restingDeviation = _mm_and_si128(resting, deviation);
+            const __m128i restingSign = _mm_and_si128(resting, sign);
+            sum2 = _mm_add_epi64(sum2, _mm_unpacklo_epi32(restingDeviation, restingSign));
+            sum2 = _mm_add_epi64(sum2, _mm_unpackhi_epi32(restingDeviation, restingSign));
+
+            const __m128i restingMagnitude = _mm_and_si128(resting, magnitude);
+            squares2 = _mm_add_epi64(squares2, _mm_mul_epu32(restingMagnitude, restingMagnitude));
+            squares2 = _mm_add_epi64(squares2, _mm_mul_epu32(_mm_srli_epi64(restingMagnitude, 32), _mm_srli_epi64(restingMagnitude, 32)));
+        }
+
+        alignas(16) std::array<int32_t, 4> minimums;
+        alignas(16) std::array<int32_t, 4> maximums;
+        alignas(16) std::array<uint32_t, 4> counts;
+        alignas(16) std::array<int64_t, 2> sums;
+        alignas(16) std::array<uint64_t, 2> squares;
+        _mm_store_si128(reinterpret_cast<__m128i*>(minimums.data()), minimum4);
+        _mm_store_si128(reinterpret_cast<__m128i*>(maximums.data()), maximum4);
+        _mm_store_si128(reinterpret_cast<__m128i*>(counts.data()), count4);
+        _mm_store_si128(reinterpret_cast<__m128i*>(sums.data()), sum2);
+        _mm_store_si128(reinterpret_cast<__m128i*>(squares.data()), squares2);
+
+        // clang-format off
+        Sums result
+        {
+            .restingCount = uint64_t{counts[0]} + counts[1] + counts[2] + counts[3],
+            .restingSum = sums[0] + sums[1],
+            .restingSquares = squares[0] + squares[1],
+            .minimum = std::ranges::min(minimums),
+            .maximum = std::ranges::max(maximums)
+        };
+        // clang-format on
+
+        for (; i < values.size(); ++i)
+        {
+            const int64_t deviation = static_cast<int64_t>(values[i]) - center;
+            result.minimum = std::min(result.minimum, values[i]);
+            result.maximum = std::max(result.maximum, values[i]);
+            if (std::abs(deviation) <= restingThreshold_)
+            {
+                ++result.restingCount;
+                result.restingSum += deviation;
+                result.restingSquares += static_cast<uint64_t>(deviation * deviation);
+            }
+        }
+        return result;
+    }
+
+    HidField field_;
+    int64_t center_;
+    int64_t restingThreshold_;
+    uint64_t count_{};
+    uint64_t restingCount_{};
+    int64_t restingSum_{};
+    uint64_t restingSquares_{};
+    int32_t minimum_{std::numeric_limits<int32_t>::max()};
+    int32_t maximum_{std::numeric_limits<int32_t>::min()};
+    std::array<uint64_t, distinctBits / 64> distinct_{};
+    Histogram<> offsets_;
+    Histogram<> jitter_;
+    Histogram<> intervals_;
+    int64_t firstTime_{};
+    int64_t lastTime_{};
+    int32_t lastValue_{};
+    bool lastResting_{};
+    double driftWeight_{};
+    double driftT_{};
+    double driftV_{};
+    double driftTT_{};
+    double driftTV_{};
+};
+
+// Merges individually time-ordered sources into one globally ordered stream with a loser tree, so each event costs
+// log2(sources) comparisons. Sources hand over batches of timestamps, which must outlive their consumption. Events
+// of one source keep their order, and ties between sources go to the lower source index. An open source without
+// pending events holds the merge back, as it might still push earlier events.
+class TimestampMerge
+{
+public:
+    struct Event
+    {
+        int64_t time;
+        uint32_t source;
+        uint64_t sequence; // Index of the event within its source
+    };
+
+    explicit TimestampMerge(size_t sourceCount)
+        : sources_(sourceCount)
+        , leafCount_{std::bit_ceil(std::max<size_t>(sourceCount, 2))}
+        , losers_(leafCount_)
+    {
+    }
+
+    void push(size_t source, std::span<const int64_t> times)
+    {
+        if (!times.empty())
+        {
+            sources_[source].batches.push_back(times);
+            dirty_ = true;
+        }
+    }
+
+    // No more events will be pushed for the source
+    void close(size_t source) noexcept
+    {
+        sources_[source].closed = true;
+        dirty_ = true;
+    }
+
+    // Moves as many events as are ready into events and returns their number
+    size_t pop(std::span<Event> events)
+    {
+        if (dirty_)
+        {
+            build();
+        }
+
+        size_t count = 0;
+        while (count < events.size())
+        {
+            const uint32_t winner = winner_;
+            if (winner >= sources_.size() || sources_[winner].batches.empty())
+            {
+                break; // Every source is either closed or blocked
+            }
+
+            Source& source = sources_[winner];
+            events[count++] = {source.batches.front()[source.position], winner, source.sequence++};
+            if (++source.position == source.batches.front().size())
+            {
+                source.batches.pop_front();
+                source.position = 0;
+            }
+            replay(winner);
+        }
+        return count;
+    }
+
+private:
+    struct Source
+    {
+        std::deque<std::span<const int64_t>> batches;
+        size_t position{}; // In the first batch
+        uint64_t sequence{};
+        bool closed{};
+    };
+
+    struct Key
+    {
+        int64_t time;
+        uint32_t rank; // Blocked sources win ties, so no event passes them
+        uint32_t source;
+
+        [[nodiscard]] bool operator<(const Key& other) const noexcept
+        {
+            return std::tie(time, rank, source) < std::tie(other.time, other.rank, other.source);
+        }
+    };
+
+    [[nodiscard]] Key getKey(uint32_t leaf) const noexcept
+    {
+        if (leaf >= sources_.size())
+        {
+            return {std::numeric_limits<int64_t>::max(), 2, leaf};
+        }
+
+        const Source& source = sources_[leaf];
+        if (!source.batches.empty())
+        {
+            return {source.batches.front()[source.position], 1, leaf};
+        }
+        return source.closed ? Key{std::numeric_limits<int64_t>::max(), 2, leaf} : Key{std::numeric_limits<int64_t>::min(), 0, leaf};
+    }
+
+    // Plays all leaves against each other; needed whenever a source other than the winner changed
+    void build()
+    {
+        std::vector<uint32_t> winners(2 * leafCount_);
+        for (uint32_t leaf = 0; leaf < leafCount_; ++leaf)
+        {
+            winners[leafCount_ + leaf] = leaf;
+        }
+
+        for (size_t node = leafCount_ - 1; node >= 1; --node)
+        {
+            const uint32_t left = winners[2 * node];
+            const uint32_t right = winners[2 * node + 1];
+            const bool leftWins = getKey(left) < getKey(right);
+            winners[node] = leftWins ? left : right;
+            losers_[node] = leftWins ? right : left;
+        }
+        winner_ = winners[1];
+        dirty_ = false;
+    }
+
+    // Plays the leaf against the losers on its path to the root after its key changed
+    void replay(uint32_t leaf) noexcept
+    {
+        uint32_t winner = leaf;
+        for (size_t node = (leafCount_ + leaf) / 2; node >= 1; node /= 2)
+        {
+            if (getKey(losers_[node]) < getKey(winner))
+            {
+                std::swap(losers_[node], winner);
+            }
+        }
+        winner_ = winner;
+    }
+
+    std::vector<Source> sources_;
+    size_t leafCount_;
+    std::vector<uint32_t> losers_; // losers_[0] is unused
+    uint32_t winner_{};
+    bool dirty_{true};
+};
+
+// Bounded multi-producer single-consumer queue. Producers reserve a whole batch of slots with one compare-exchange
+// and publish each slot through its sequence number, so they never wait on each other's copying and the consumer
+// never takes a lock. Every slot owns its cache line, so producers filling neighbouring slots don't share one.
+template<typename T, size_t Capacity>
+class MpscQueue
+{
+    static_assert(std::has_single_bit(Capacity), "Capacity must be a power of two");
+
+public:
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    MpscQueue()
+        : slots_{std::make_unique<Slot[]>(Capacity)}
+    {
+        for (size_t i = 0; i < Capacity; ++i)
+        {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Enqueues all items or, if there isn't room for all of them, none
+    [[nodiscard]] bool tryPush(std::span<const T> items) noexcept
+    {
+        _ASSERT(!items.empty() && items.size() <= Capacity);
+        uint64_t position = tail_.load(std::memory_order_relaxed);
+        while (true)
+        {
+            // The consumer frees slots in order, so the batch fits if its last slot is free
+            const uint64_t last = position + items.size() - 1;
+            const auto lag = static_cast<int64_t>(slots_[last & mask].sequence.load(std::memory_order_acquire) - last);
+            if (lag < 0)
+            {
+                return false;
+            }
+
+            if (lag == 0 && tail_.compare_exchange_weak(position, position + items.size(), std::memory_order_relaxed))
+            {
+                break;
+            }
+
+            if (lag > 0)
+            {
+                position = tail_.load(std::memory_order_relaxed); // Another producer got there first
+            }
+        }
+
+        for (size_t i = 0; i < items.size(); ++i)
+        {
+            Slot& slot = slots_[(position + i) & mask];
+            slot.value = items[i];
+            slot.sequence.store(position + i + 1, std::memory_order_release);
+        }
+        return true;
+    }
+
+    // Only the consumer thread may pop; returns the number of items moved into items
+    [[nodiscard]] size_t pop(std::span<T> items) noexcept
+    {
+        size_t count = 0;
+        for (; count < items.size(); ++count, ++head_)
+        {
+            Slot& slot = slots_[head_ & mask];
+            if (slot.sequence.load(std::memory_order_acquire) != head_ + 1)
+            {
+                break;
+            }
+
+            items[count] = slot.value;
+            slot.sequence.store(head_ + Capacity, std::memory_order_release);
+        }
+        return count;
+    }
+
+private:
+    static constexpr uint64_t mask = Capacity - 1;
+
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> sequence; // Position + 1 once published, position + Capacity once consumed
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<uint64_t> tail_{};
+    alignas(64) uint64_t head_{};
+};
+
+// A keyboard or mouse event read on a capture thread; together with the sequence number it fills a cache line
+struct CapturedInput
+{
+    int64_t time;
+    RAWINPUTHEADER header;
+    union
+    {
+        RAWKEYBOARD keyboard;
+        RAWMOUSE mouse;
+    };
+};
+
+// Carries captured input from any number of capture threads to the window consuming it, which is posted a message
+// whenever input arrives while it isn't already notified
+class CaptureChannel
+{
+public:
+    static constexpr size_t capacity = 16384;
+
+    CaptureChannel(HWND consumer, UINT message) noexcept
+        : consumer_{consumer}
+        , message_{message}
+    {
+    }
+
+    void push(std::span<const CapturedInput> events) noexcept
+    {
+        if (!queue_.tryPush(events))
+        {
+            dropped_.fetch_add(events.size(), std::memory_order_relaxed);
+        }
+
+        if (!notified_.exchange(true, std::memory_order_acq_rel))
+        {
+            PostMessageW(consumer_, message_, 0, 0);
+        }
+    }
+
+    // Input pushed after the notification is cleared either is popped or notifies again
+    [[nodiscard]] size_t pop(std::span<CapturedInput> events) noexcept
+    {
+        notified_.exchange(false, std::memory_order_acq_rel);
+        return queue_.pop(events);
+    }
+
+    // Events lost to a full queue since the last call
+    [[nodiscard]] uint64_t takeDropped() noexcept
+    {
+        return dropped_.exchange(0, std::memory_order_relaxed);
+    }
+
+private:
+    MpscQueue<CapturedInput, capacity> queue_;
+    alignas(64) std::atomic<bool> notified_{};
+    std::atomic<uint64_t> dropped_{};
+    const HWND consumer_;
+    const UINT message_;
+};
+
+// How a capture thread is scheduled. Busy polling trades a core for never sleeping on a wake-up.
+struct CaptureSchedule
+{
+    int core{-1}; // Any core if negative
+    bool timeCritical{};
+    bool busyPoll{};
+};
+
+// Receives raw input for a group of device usages on its own thread, through a message-only window, and reads it
+// in batches with GetRawInputBuffer(). Since that window is never in the foreground, input is captured with
+// RIDEV_INPUTSINK, but only kept while this process is in the foreground, just like without capture threads, so
+// keystrokes typed into other applications are never recorded. Device changes are forwarded to the consumer
+// window as WM_INPUT_DEVICE_CHANGE.
+//
+// The thread measures its own scheduling delay: when waiting, how late a high-resolution timer armed for every
+// probe interval wakes it up, and when busy polling, the gaps between consecutive polls. It publishes a copy of
+// the measurements every publishInterval for other threads to read.
+class RawInputCaptureThread
+{
+public:
+    static constexpr int64_t probeInterval = 10'000; // 100 ns units, i.e. 1 ms
+    static constexpr int64_t publishInterval = 100; // Milliseconds
+
+    RawInputCaptureThread(const RawInputCaptureThread&) = delete;
+    RawInputCaptureThread& operator=(const RawInputCaptureThread&) = delete;
+
+    RawInputCaptureThread(CaptureChannel& channel, std::span<const RAWINPUTDEVICE> devices, HWND consumer, CaptureSchedule schedule)
+        : devices_(devices.begin(), devices.end())
+        , schedule_{schedule}
+    {
+        std::promise<DWORD> started;
+        std::future<DWORD> error = started.get_future();
+        thread_ = std::jthread([this, &channel, &started, consumer](std::stop_token stopToken) { run(stopToken, channel, started, consumer); });
+        if (const DWORD code = error.get(); code != ERROR_SUCCESS)
+        {
+            thread_.join();
+            THROW_SYSTEM_ERROR(code);
+        }
+    }
+
+    ~RawInputCaptureThread()
+    {
+        thread_.request_stop();
+        PostMessageW(window_, WM_NULL, 0, 0); // Wakes the thread up to see the stop request
+    }
+
+    [[nodiscard]] const CaptureSchedule& schedule() const noexcept
+    {
+        return schedule_;
+    }
+
+    // Adds the last published scheduling delays, in nanoseconds, to delay
+    void copySchedulingDelay(Histogram<>& delay) const
+    {
+        std::lock_guard lock(publishedMutex_);
+        delay.merge(publishedDelay_);
+    }
+
+private:
+    [[nodiscard]] DWORD start()
+    {
+        if (schedule_.core >= 0 && SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR{1} << schedule_.core) == 0)
+        {
+            return GetLastError();
+        }
+
+        if (schedule_.timeCritical && !SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL))
+        {
+            return GetLastError();
+        }
+
+        window_ = CreateWindowExW(0, L"Message", nullptr, 0, 0, 0, 0, 0, HWND_MESSAGE, nullptr, nullptr, nullptr);
+        if (window_ == nullptr)
+        {
+            return GetLastError();
+        }
+
+        for (RAWINPUTDEVICE& device : devices_)
+        {
+            device.dwFlags |= RIDEV_INPUTSINK | RIDEV_DEVNOTIFY;
+            device.hwndTarget = window_;
+        }
+
+        if (!RegisterRawInputDevices(devices_.data(), static_cast<UINT>(devices_.size()), sizeof(RAWINPUTDEVICE)))
+        {
+            const DWORD error = GetLastError();
+            DestroyWindow(window_);
+            return error;
+        }
+        return ERROR_SUCCESS;
+    }
+
+    void run(std::stop_token stopToken, CaptureChannel& channel, std::promise<DWORD>& started, HWND consumer)
+    {
+        if (const DWORD error = start(); error != ERROR_SUCCESS)
+        {
+            started.set_value(error);
+            return;
+        }
+        started.set_value(ERROR_SUCCESS);
+
+        // GetRawInputBuffer() wants RAWINPUT structures aligned to 8 bytes
+        std::vector<uint64_t> buffer(8192);
+        if (schedule_.busyPoll)
+        {
+            int64_t lastPoll = PerformanceCounter::now();
+            while (!stopToken.stop_requested())
+            {
+                const int64_t now = PerformanceCounter::now();
+                recordDelay(PerformanceCounter::toNanoseconds(now - lastPoll), now);
+                lastPoll = now;
+                if (HIWORD(GetQueueStatus(QS_ALLINPUT)) != 0)
+                {
+                    readInput(channel, buffer);
+                    forwardMessages(consumer);
+                }
+                else if (schedule_.timeCritical)
+                {
+                    // Nothing below time-critical priority would run on this core otherwise, e.g. the consumer
+                    SwitchToThread();
+                }
+            }
+        }
+        else
+        {
+            // Without the high-resolution flag, timers only fire on the system timer tick
+            const HANDLE timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+            int64_t deadline = armProbe(timer);
+            while (!stopToken.stop_requested())
+            {
+                const DWORD count = timer != nullptr ? 1 : 0;
+                if (MsgWaitForMultipleObjectsEx(count, &timer, INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE) == WAIT_OBJECT_0 && count != 0)
+                {
+                    const int64_t now = PerformanceCounter::now();
+                    recordDelay(PerformanceCounter::toNanoseconds(std::max<int64_t>(now - deadline, 0)), now);
+                    deadline = armProbe(timer);
+                    continue;
+                }
+                readInput(channel, buffer);
+                forwardMessages(consumer);
+            }
+
+            if (timer != nullptr)
+            {
+                CloseHandle(timer);
+            }
+        }
+
+        for (RAWINPUTDEVICE& device : devices_)
+        {
+            device.dwFlags = RIDEV_REMOVE;
+            device.hwndTarget = nullptr;
+        }
+        RegisterRawInputDevices(devices_.data(), static_cast<UINT>(devices_.size()), sizeof(RAWINPUTDEVICE));
+        DestroyWindow(window_);
+    }
+
+    void recordDelay(uint64_t nanoseconds, int64_t now) noexcept
+    {
+        schedulingDelay_.record(nanoseconds);
+        if (now - lastPublished_ >= publishInterval * PerformanceCounter::frequency() / 1000)
+        {
+            std::lock_guard lock(publishedMutex_);
+            publishedDelay_.reset();
+            publishedDelay_.merge(schedulingDelay_);
+            lastPublished_ = now;
+        }
+    }
+
+    // Returns the time the timer is due
+    [[nodiscard]] static int64_t armProbe(HANDLE timer) noexcept
+    {
+        LARGE_INTEGER dueTime{.QuadPart = -probeInterval};
+        const int64_t now = PerformanceCounter::now();
+        if (timer != nullptr)
+        {
+            SetWaitableTimer(timer, &dueTime, 0, nullptr, nullptr, FALSE);
+        }
+        return now + probeInterval * PerformanceCounter::frequency() / 10'000'000;
+    }
+
+    static void readInput(CaptureChannel& channel, std::vector<uint64_t>& buffer) noexcept
+    {
+        std::array<CapturedInput, 64> batch;
+        while (true)
+        {
+            UINT size = static_cast<UINT>(buffer.size() * sizeof(uint64_t));
+            RAWINPUT* raw = reinterpret_cast<RAWINPUT*>(buffer.data());
+            const UINT count = GetRawInputBuffer(raw, &size, sizeof(RAWINPUTHEADER));
+            if (count == 0 || count == static_cast<UINT>(-1))
+            {
+                break;
+            }
+
+            const int64_t time = PerformanceCounter::now();
+            const bool foreground = isProcessInForeground();
+            size_t batched = 0;
+            for (UINT i = 0; i < count; ++i, raw = NEXTRAWINPUTBLOCK(raw))
+            {
+                if (raw->header.wParam == RIM_INPUTSINK && !foreground)
+                {
+                    continue;
+                }
+
+                CapturedInput& event = batch[batched];
+                event.time = time;
+                event.header = raw->header;
+                if (raw->header.dwType == RIM_TYPEKEYBOARD)
+                {
+                    event.keyboard = raw->data.keyboard;
+                }
+                else if (raw->header.dwType == RIM_TYPEMOUSE)
+                {
+                    event.mouse = raw->data.mouse;
+                }
+                else
+                {
+                    continue;
+                }
+
+                if (++batched == batch.size())
+                {
+                    channel.push(batch);
+                    batched = 0;
+                }
+            }
+
+            if (batched != 0)
+            {
+                channel.push(std::span(batch).first(batched));
+            }
+        }
+    }
+
+    // All input to the message-only window comes as RIM_INPUTSINK, whichever window is in the foreground
+    [[nodiscard]] static bool isProcessInForeground() noexcept
+    {
+        DWORD processId = 0;
+        GetWindowThreadProcessId(GetForegroundWindow(), &processId);
+        return processId == GetCurrentProcessId();
+    }
+
+    // WM_INPUT posted since the last read stays queued for the next GetRawInputBuffer() call, as dispatching it
+    // would discard its input
+    static void forwardMessages(HWND consumer) noexcept
+    {
+        MSG msg;
+        while (PeekMessageW(&msg, nullptr, 0, WM_INPUT - 1, PM_REMOVE) || PeekMessageW(&msg, nullptr, WM_INPUT + 1, std::numeric_limits<UINT>::max(), PM_REMOVE))
+        {
+            if (msg.message == WM_INPUT_DEVICE_CHANGE)
+            {
+                PostMessageW(consumer, msg.message, msg.wParam, msg.lParam);
+            }
+            DispatchMessageW(&msg);
+        }
+    }
+
+    std::vector<RAWINPUTDEVICE> devices_;
+    const CaptureSchedule schedule_;
+    Histogram<> schedulingDelay_; // Only used by the capture thread
+    Histogram<> publishedDelay_;
+    mutable std::mutex publishedMutex_;
+    int64_t lastPublished_{};
+    HWND window_{};
+    std::jthread thread_; // Last, so it stops before the members it uses are destroyed
+};
+
+// Keeps the most recent input in a fixed ring of blocks and, when triggered, writes the events of the last seconds
+// to a CSV file. Events are delta-encoded into the blocks, mostly as LEB128 varints, which packs a keyboard event
+// into about 7 bytes. Memory is allocated once up front. Dumps run on their own thread, which copies blocks out and
+// drops those the ring overwrote meanwhile, as seqlock readers do, so ingest never waits for a dump. The block being
+// written publishes its size after each record, so dumps include it without sealing it early. Anomaly triggers are
+// held off for the dump length after an anomaly dump, so a misbehaving device doesn't dump over and over.
+//
+// Besides trigger(), setting the named event externalTriggerName(processId) from another process requests a dump;
+// the owner window is posted externalTriggerMessage and is expected to call trigger() in turn. The name ends in the
+// process ID, e.g. Local\RawInputViewer.FlightRecorder.Trigger.1234, so each running instance has its own event.
+class FlightRecorder
+{
+public:
+    enum class Trigger : uint8_t
+    {
+        Manual,
+        Hotkey,
+        External,
+        Anomaly
+    };
+
+    struct Status
+    {
+        uint64_t dumps;
+        uint64_t failedDumps;
+        uint64_t ignoredTriggers; // While a dump was running or anomaly triggers were held off
+        uint64_t lostBlocks; // Overwritten before they could be dumped
+        std::wstring lastPath;
+    };
+
+    static constexpr size_t blockSize = 64 * 1024;
+    static constexpr size_t maxHidBytes = 1024; // Longer reports are truncated
+
+    [[nodiscard]] static std::wstring externalTriggerName(DWORD processId)
+    {
+        return std::format(L"Local\\RawInputViewer.FlightRecorder.Trigger.{}", processId);
+    }
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    FlightRecorder(size_t megabytes, uint32_t seconds, HWND owner, UINT externalTriggerMessage)
+        : blockCount_{std::max<size_t>(megabytes * 1024 * 1024 / blockSize, 2)}
+        , seconds_{seconds}
+        , headers_{std::make_unique<BlockHeader[]>(blockCount_)}
+        , blocks_{std::make_unique_for_overwrite<uint8_t[]>(blockCount_ * blockSize)}
+        , scratch_{std::make_unique_for_overwrite<uint8_t[]>(blockSize)}
+        , owner_{owner}
+        , externalTriggerMessage_{externalTriggerMessage}
+    {
+        requestEvent_ = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+        externalEvent_ = CreateEventW(nullptr, FALSE, FALSE, externalTriggerName(GetCurrentProcessId()).c_str());
+        if (requestEvent_ == nullptr || externalEvent_ == nullptr)
+        {
+            const DWORD error = GetLastError();
+            closeEvents();
+            THROW_SYSTEM_ERROR(error);
+        }
+
+        headers_[open_].sequence.store(nextSequence_, std::memory_order_relaxed);
+        text_.reserve(textCapacity);
+        dumper_ = std::jthread([this](std::stop_token stopToken) { runDumper(stopToken); });
+    }
+
+    ~FlightRecorder()
+    {
+        dumper_.request_stop();
+        SetEvent(requestEvent_);
+        dumper_.join();
+        closeEvents();
+    }
+
+    // Recording and triggering are for the ingest thread only
+
+    void recordKeyboard(int64_t time, uint8_t device, const RAWKEYBOARD& keyboard) noexcept
+    {
+        uint8_t* out = beginRecord(time, Kind::Keyboard, device, 16);
+        out = putVarUInt(out, keyboard.MakeCode);
+        out = putVarUInt(out, keyboard.Flags);
+        out = putVarUInt(out, keyboard.VKey);
+        endRecord(out);
+    }
+
+    void recordMouse(int64_t time, uint8_t device, const RAWMOUSE& mouse) noexcept
+    {
+        uint8_t* out = beginRecord(time, Kind::Mouse, device, 32);
+        out = putVarUInt(out, toZigZag(mouse.lLastX));
+        out = putVarUInt(out, toZigZag(mouse.lLastY));
+        out = putVarUInt(out, mouse.usButtonFlags);
+        out = putVarUInt(out, mouse.usButtonData);
+        out = putVarUInt(out, mouse.usFlags);
+        endRecord(out);
+    }
+
+    void recordHid(int64_t time, uint8_t device, std::span<const uint8_t> report) noexcept
+    {
+        const size_t size = std::min(report.size(), maxHidBytes);
+        uint8_t* out = beginRecord(time, Kind::Hid, device, 8 + size);
+        out = putVarUInt(out, size);
+        endRecord(std::copy_n(report.data(), size, out));
+    }
+
+    void recordDeviceChange(int64_t time, uint8_t device, DeviceChange change) noexcept
+    {
+        uint8_t* out = beginRecord(time, Kind::DeviceChange, device, 1);
+        *out++ = static_cast<uint8_t>(change);
+        endRecord(out);
+    }
+
+    // Dumps the seconds before time unless the previous dump is still running or, for anomalies, an anomaly dump
+    // was triggered within the last seconds
+    bool trigger(int64_t time, Trigger reason) noexcept
+    {
+        const int64_t holdOff = static_cast<int64_t>(seconds_) * PerformanceCounter::frequency();
+        if ((reason == Trigger::Anomaly && lastAnomalyTime_ != 0 && time - lastAnomalyTime_ < holdOff) || dumping_.exchange(true, std::memory_order_acquire))
+        {
+            ignoredTriggers_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        lastAnomalyTime_ = reason == Trigger::Anomaly ? time : lastAnomalyTime_;
+        request_ = {time, reason, nextSequence_};
+        SetEvent(requestEvent_);
+        return true;
+    }
+
+    [[nodiscard]] size_t capacity() const noexcept
+    {
+        return blockCount_ * blockSize;
+    }
+
+    [[nodiscard]] uint32_t seconds() const noexcept
+    {
+        return seconds_;
+    }
+
+    [[nodiscard]] Status status() const
+    {
+        std::lock_guard lock(statusMutex_);
+        Status status = status_;
+        status.ignoredTriggers = ignoredTriggers_.load(std::memory_order_relaxed);
+        return status;
+    }
+
+private:
+    enum class Kind : uint8_t
+    {
+        Keyboard,
+        Mouse,
+        Hid,
+        DeviceChange
+    };
+
+    struct BlockHeader
+    {
+        std::atomic<uint64_t> sequence; // Changes when the block is reused
+        std::atomic<int64_t> firstTime;
+        std::atomic<int64_t> lastTime;
+        std::atomic<size_t> size; // Of the records written so far
+    };
+
+    struct Request
+    {
+        int64_t time;
+        Trigger reason;
+        uint64_t newestSequence; // The block being written at the time
+    };
+
+    static constexpr size_t textCapacity = 1024 * 1024;
+    static constexpr size_t maxLineLength = 2 * maxHidBytes + 64;
+    static constexpr std::array<std::string_view, 4> triggerNames{"manual", "hotkey", "external", "anomaly"};
+
+    [[nodiscard]] static uint64_t toZigZag(int64_t value) noexcept
+    {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    [[nodiscard]] static int64_t fromZigZag(uint64_t value) noexcept
+    {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    [[nodiscard]] static uint8_t* putVarUInt(uint8_t* out, uint64_t value) noexcept
+    {
+        while (value >= 0x80)
+        {
+            *out++ = static_cast<uint8_t>((value & 0x7f) | 0x80);
+            value >>= 7;
+        }
+        *out++ = static_cast<uint8_t>(value);
+        return out;
+    }
+
+    // Records are the time delta to the previous record, kind, device, and payload
+    [[nodiscard]] uint8_t* beginRecord(int64_t time, Kind kind, uint8_t device, size_t payloadSize) noexcept
+    {
+        if (blockSize - used_ < payloadSize + 12)
+        {
+            seal();
+        }
+
+        BlockHeader& header = headers_[open_];
+        if (used_ == 0)
+        {
+            header.firstTime.store(time, std::memory_order_relaxed);
+            lastTime_ = time;
+        }
+
+        uint8_t* out = putVarUInt(blocks_.get() + open_ * blockSize + used_, toZigZag(time - lastTime_));
+        *out++ = static_cast<uint8_t>(kind);
+        *out++ = device;
+        header.lastTime.store(std::max(lastTime_, time), std::memory_order_relaxed);
+        lastTime_ = time;
+        return out;
+    }
+
+    void endRecord(const uint8_t* end) noexcept
+    {
+        used_ = static_cast<size_t>(end - (blocks_.get() + open_ * blockSize));
+        headers_[open_].size.store(used_, std::memory_order_release);
+    }
+
+    // Starts writing over the oldest block; readers still copying it see its sequence change
+    void seal() noexcept
+    {
+        open_ = (open_ + 1) % blockCount_;
+        headers_[open_].sequence.store(++nextSequence_, std::memory_order_relaxed);
+        headers_[open_].size.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        used_ = 0;
+    }
+
+    void runDumper(std::stop_token stopToken)
+    {
+        const std::array<HANDLE, 2> events{requestEvent_, externalEvent_};
+        while (!stopToken.stop_requested())
+        {
+            const DWORD signaled = WaitForMultipleObjects(static_cast<DWORD>(events.size()), events.data(), FALSE, INFINITE);
+            if (stopToken.stop_requested())
+            {
+                break;
+            }
+
+            if (signaled == WAIT_OBJECT_0 + 1)
+            {
+                PostMessageW(owner_, externalTriggerMessage_, 0, 0);
+            }
+            else if (signaled == WAIT_OBJECT_0)
+            {
+                dump(request_);
+                dumping_.store(false, std::memory_order_release);
+            }
+        }
+    }
+
+    void dump(const Request& request)
+    {
+        const std::wstring path = makeTempFilePath(std::format(L"RawInputViewer-{}-{}.flight.csv", GetCurrentProcessId(), GetTickCount64()));
+        const int64_t frequency = PerformanceCounter::frequency();
+        const int64_t cutoff = request.time - static_cast<int64_t>(seconds_) * frequency;
+        // The ring holds the block being written and the blockCount_ - 1 before it
+        const uint64_t first = request.newestSequence > blockCount_ ? request.newestSequence - blockCount_ + 1 : 1;
+        uint64_t lost = 0;
+        bool failed = false;
+        try
+        {
+            OutputFile file(path.c_str());
+            text_.clear();
+            std::format_to(std::back_inserter(text_), "time_ms,stream,device,fields\n# {} trigger\n", triggerNames[std::to_underlying(request.reason)]);
+            for (uint64_t sequence = first; sequence <= request.newestSequence; ++sequence)
+            {
+                const BlockHeader& header = headers_[(sequence - 1) % blockCount_];
+                if (header.sequence.load(std::memory_order_acquire) != sequence)
+                {
+                    ++lost;
+                    continue;
+                }
+
+                // The size is acquired, so the records it covers are complete even in the block being written
+                const size_t size = header.size.load(std::memory_order_acquire);
+                const int64_t firstTime = header.firstTime.load(std::memory_order_relaxed);
+                const int64_t lastTime = header.lastTime.load(std::memory_order_relaxed);
+                std::memcpy(scratch_.get(), blocks_.get() + (sequence - 1) % blockCount_ * blockSize, size);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (header.sequence.load(std::memory_order_relaxed) != sequence)
+                {
+                    ++lost;
+                }
+                else if (lastTime >= cutoff)
+                {
+                    decode(std::span(scratch_.get(), size), firstTime, request.time, cutoff, file);
+                }
+            }
+            file.write(text_);
+        }
+        catch (const std::exception&)
+        {
+            failed = true;
+        }
+
+        std::lock_guard lock(statusMutex_);
+        status_.dumps += failed ? 0 : 1;
+        status_.failedDumps += failed ? 1 : 0;
+        status_.lostBlocks += lost;
+        status_.lastPath = path;
+    }
+
+    void decode(std::span<const uint8_t> block, int64_t time, int64_t triggerTime, int64_t cutoff, OutputFile& file)
+    {
+        const double millisecondsPerTick = 1000.0 / static_cast<double>(PerformanceCounter::frequency());
+        std::span<const std::byte> in = std::as_bytes(block);
+        uint64_t delta = 0;
+        while (readVarUInt(in, delta) && in.size() >= 2)
+        {
+            time += fromZigZag(delta);
+            const auto kind = static_cast<Kind>(in[0]);
+            const auto device = static_cast<unsigned>(in[1]);
+            in = in.subspan(2);
+
+            const double ms = static_cast<double>(time - triggerTime) * millisecondsPerTick;
+            std::array<uint64_t, 5> fields{};
+            const size_t fieldCount = kind == Kind::Keyboard ? 3 : kind == Kind::Mouse ? 5 : kind == Kind::Hid ? 1 : 0;
+            for (size_t i = 0; i < fieldCount; ++i)
+            {
+                if (!readVarUInt(in, fields[i]))
+                {
+                    return;
+                }
+            }
+
+            const bool keep = time >= cutoff && time <= triggerTime; // The block being written goes on past the trigger
+            switch (kind)
+            {
+                case Kind::Keyboard:
+                {
+                    if (keep)
+                    {
+                        std::format_to(std::back_inserter(text_), "{:.3f},keyboard,{},{:#06x},{:#06x},{:#04x}\n", ms, device, fields[0], fields[1], fields[2]);
+                    }
+                    break;
+                }
+                case Kind::Mouse:
+                {
+                    if (keep)
+                    {
+                        std::format_to(std::back_inserter(text_), "{:.3f},mouse,{},{},{},{:#06x},{},{:#06x}\n", ms, device, fromZigZag(fields[0]), fromZigZag(fields[1]), fields[2], static_cast<SHORT>(fields[3]), fields[4]);
+                    }
+                    break;
+                }
+                case Kind::Hid:
+                {
+                    if (fields[0] > in.size())
+                    {
+                        return;
+                    }
+
+                    if (keep)
+                    {
+                        std::format_to(std::back_inserter(text_), "{:.3f},hid,{},", ms, device);
+                        for (const std::byte byte : in.first(fields[0]))
+                        {
+                            std::format_to(std::back_inserter(text_), "{:02x}", std::to_integer<unsigned>(byte));
+                        }
+                        text_ += '\n';
+                    }
+                    in = in.subspan(fields[0]);
+                    break;
+                }
+                case Kind::DeviceChange:
+                {
+                    if (in.empty())
+                    {
+                        return;
+                    }
+
+                    if (keep)
+                    {
+                        const bool arrival = static_cast<DeviceChange>(in[0]) == DeviceChange::Arrival;
+                        std::format_to(std::back_inserter(text_), "{:.3f},device,{},{}\n", ms, device, arrival ? "arrival" : "removal");
+                    }
+                    in = in.subspan(1);
+                    break;
+                }
+                default:
+                {
+                    return; // Corrupt block
+                }
+            }
+
+            // Flush before the reserved text buffer would have to grow
+            if (text_.size() > textCapacity - maxLineLength)
+            {
+                file.write(text_);
+                text_.clear();
+            }
+        }
+    }
+
+    void closeEvents() noexcept
+    {
+        for (HANDLE event : {requestEvent_, externalEvent_})
+        {
+            if (event != nullptr)
+            {
+                CloseHandle(event);
+            }
+        }
+    }
+
+    const size_t blockCount_;
+    const uint32_t seconds_;
+    std::unique_ptr<BlockHeader[]> headers_;
+    std::unique_ptr<uint8_t[]> blocks_;
+    std::unique_ptr<uint8_t[]> scratch_; // The dumper's copy of the block it decodes
+    size_t open_{}; // The block being written
+    size_t used_{};
+    int64_t lastTime_{};
+    uint64_t nextSequence_{1}; // Of the block being written
+    int64_t lastAnomalyTime_{}; // Of the last anomaly dump
+    std::atomic<bool> dumping_{};
+    std::atomic<uint64_t> ignoredTriggers_{};
+    Request request_{}; // Handed to the dumper along with dumping_
+    std::string text_;
+    mutable std::mutex statusMutex_;
+    Status status_{};
+    const HWND owner_;
+    const UINT externalTriggerMessage_;
+    HANDLE requestEvent_{};
+    HANDLE externalEvent_{};
+    std::jthread dumper_; // Last, so it stops before the members it uses are destroyed
+};
+
+enum class HotPathStage : uint32_t
+{
+    Ingest,
+    Normalize,
+    Store,
+    Format,
+    Count
+};
+
+#ifdef RAWINPUTVIEWER_COUNT_ALLOCATIONS
+
+// Counts calls to the global operator new, which RawInputViewer.cpp replaces when
+// RAWINPUTVIEWER_COUNT_ALLOCATIONS is defined. Allocations are attributed to the innermost
+// active HotPathStage, so nested stages (e.g. Normalize inside Ingest) are not counted twice.
+// Counting is per thread, so allocations made by worker threads meanwhile aren't attributed
+// to a stage running on the UI thread.
+class AllocationCounter
+{
+public:
+    // Allocations made during the first calls of a stage (lazy initialization,
+    // growing containers) are reported separately from the steady state.
+    static constexpr uint64_t warmUpCalls = 1024;
+
+    class Scope
+    {
+    public:
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        explicit Scope(HotPathStage stage) noexcept
+            : stage_{stage}
+            , allocationsAtEntry_{AllocationCounter::allocations()}
+            , attributedAtEntry_{attributed_}
+        {
+        }
+
+        ~Scope()
+        {
+            const uint64_t own = (AllocationCounter::allocations() - allocationsAtEntry_) - (attributed_ - attributedAtEntry_);
+            attributed_ += own;
+            AllocationCounter::record(stage_, own);
+        }
+
+    private:
+        const HotPathStage stage_;
+        const uint64_t allocationsAtEntry_;
+        const uint64_t attributedAtEntry_;
+    };
+
+    static void countAllocation() noexcept
+    {
+        ++allocations_;
+    }
+
+    // Allocations made by the calling thread
+    [[nodiscard]] static uint64_t allocations() noexcept
+    {
+        return allocations_;
+    }
+
+    [[nodiscard]] static uint64_t calls(HotPathStage stage) noexcept
+    {
+        return stages_[std::to_underlying(stage)].calls.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] static uint64_t steadyStateAllocations(HotPathStage stage) noexcept
+    {
+        return stages_[std::to_underlying(stage)].steadyStateAllocations.load(std::memory_order_relaxed);
+    }
+
+    // Starts counting afresh, e.g. once the stores have grown to their working size
+    static void reset() noexcept
+    {
+        for (Counters& counters : stages_)
+        {
+            counters.calls.store(0, std::memory_order_relaxed);
+            counters.allocations.store(0, std::memory_order_relaxed);
+            counters.steadyStateAllocations.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Writes the per-stage counters to the debugger output
+    static void report()
+    {
+        constexpr const wchar_t* names[] = {L"Ingest", L"Normalize", L"Store", L"Format"};
+        static_assert(std::size(names) == std::to_underlying(HotPathStage::Count));
+
+        for (size_t i = 0; i < std::size(names); ++i)
+        {
+            const HotPathStage stage = static_cast<HotPathStage>(i);
+            const uint64_t stageCalls = calls(stage);
+            const uint64_t steadyCalls = stageCalls > warmUpCalls ? stageCalls - warmUpCalls : 0;
+            const uint64_t steadyAllocations = steadyStateAllocations(stage);
+            const std::wstring line = std::format(
+                L"RawInputViewer: {:<10} {:>10} calls, {:>8} allocations, {:>8} after warm-up ({:.3f} per call)\n", names[i], stageCalls,
+                stages_[i].allocations.load(std::memory_order_relaxed), steadyAllocations,
+                steadyCalls > 0 ? static_cast<double>(steadyAllocations) / static_cast<double>(steadyCalls) : 0.0);
+            OutputDebugStringW(line.c_str());
+        }
+    }
+
+private:
+    struct Counters
+    {
+        std::atomic<uint64_t> calls;
+        std::atomic<uint64_t> allocations;
+        std::atomic<uint64_t> steadyStateAllocations;
+    };
+
+    static void record(HotPathStage stage, uint64_t allocations) noexcept
+    {
+        Counters& counters = stages_[std::to_underlying(stage)];
+        const uint64_t call = counters.calls.fetch_add(1, std::memory_order_relaxed);
+        counters.allocations.fetch_add(allocations, std::memory_order_relaxed);
+        if (call >= warmUpCalls)
+        {
+            counters.steadyStateAllocations.fetch_add(allocations, std::memory_order_relaxed);
+        }
+    }
+
+    static inline thread_local uint64_t allocations_;
+    static inline thread_local uint64_t attributed_;
+    static inline std::array<Counters, std::to_underlying(HotPathStage::Count)> stages_;
+};
+
+#define COUNT_ALLOCATIONS(stage) const AllocationCounter::Scope CONCATENATE(allocationScope, __LINE__)(stage)
+
+#else // !RAWINPUTVIEWER_COUNT_ALLOCATIONS
+
+#define COUNT_ALLOCATIONS(stage) ((void)0)
+
+#endif // RAWINPUTVIEWER_COUNT_ALLOCATIONS
+
+#ifdef RAWINPUTVIEWER_ENABLE_TRACING
+
+// Records scoped spans into per-thread ring buffers and exports them in the Chrome Trace Event
+// format, which can be loaded into chrome://tracing or https://ui.perfetto.dev. Each thread only
+// ever writes to its own buffer, so recording is wait-free; buffers are never freed, so a dump
+// can safely walk them while other threads keep recording.
+class Tracer
+{
+public:
+    class Scope
+    {
+    public:
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        explicit Scope(const char* name) noexcept
+            : name_{name}
+            , begin_{now()}
+        {
+        }
+
+        ~Scope()
+        {
+            threadBuffer().record({.name = name_, .begin = begin_, .end = now()});
+        }
+
+    private:
+        const char* name_;
+        const int64_t begin_;
+    };
+
+    // Writes all spans still held by the ring buffers as Chrome Trace Event JSON
+    static void writeJson(OutputFile& file)
+    {
+        const double ticksPerMicrosecond = static_cast<double>(PerformanceCounter::frequency()) / 1'000'000.0;
+        const DWORD processId = GetCurrentProcessId();
+
+        std::string json = R"({"displayTimeUnit":"ns","traceEvents":[)";
+        bool first = true;
+        std::vector<Span> spans;
+        for (const ThreadBuffer* buffer = buffers_.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next)
+        {
+            buffer->copyTo(spans);
+            for (const Span& span : spans)
+            {
+                std::format_to(
+                    std::back_inserter(json), R"({}{{"name":"{}","ph":"X","ts":{:.3f},"dur":{:.3f},"pid":{},"tid":{}}})", first ? "" : ",", span.name,
+                    static_cast<double>(span.begin) / ticksPerMicrosecond, static_cast<double>(span.end - span.begin) / ticksPerMicrosecond, processId, buffer->threadId);
+                first = false;
+            }
+        }
+        json += "]}";
+
+        file.write(json);
+    }
+
+private:
+    struct Span
+    {
+        const char* name;
+        int64_t begin;
+        int64_t end;
+    };
+
+    struct ThreadBuffer
+    {
+        // Keeps the most recent 64k spans per thread (1.5 MB on x64)
+        static constexpr size_t capacity = 65536;
+
+        void record(const Span& span) noexcept
+        {
+            const uint64_t index = written.load(std::memory_order_relaxed);
+            spans[index % capacity] = span;
+            written.store(index + 1, std::memory_order_release);
+        }
+
+        // Copies the spans in recording order. Spans that the owning thread may have overwritten
+        // while copying are discarded by re-reading the write position afterwards. Once the ring is
+        // full, the oldest slot is the one the owning thread writes next, possibly while it is being
+        // copied, so it is discarded as well.
+        void copyTo(std::vector<Span>& out) const
+        {
+            const uint64_t end = written.load(std::memory_order_acquire);
+            const uint64_t begin = end > capacity ? end - capacity : 0;
+            const uint64_t inProgress = end >= capacity ? 1 : 0;
+
+            out.clear();
+            out.reserve(static_cast<size_t>(end - begin));
+            for (uint64_t i = begin; i < end; ++i)
+            {
+                out.push_back(spans[i % capacity]);
+            }
+
+            const uint64_t overwritten = written.load(std::memory_order_acquire) - end + inProgress;
+            out.erase(out.begin(), out.begin() + static_cast<ptrdiff_t>(std::min<uint64_t>(overwritten, out.size())));
+        }
+
+        std::array<Span, capacity> spans;
+        std::atomic<uint64_t> written;
+        DWORD threadId;
+        ThreadBuffer* next;
+    };
+
+    [[nodiscard]] static int64_t now() noexcept
+    {
+        return PerformanceCounter::now();
+    }
+
+    [[nodiscard]] static ThreadBuffer& threadBuffer()
+    {
+        thread_local ThreadBuffer* buffer = registerThreadBuffer();
+        return *buffer;
+    }
+
+    // Called once per thread; the buffer is intentionally leaked so it can be dumped after the thread exits
+    [[nodiscard]] static ThreadBuffer* registerThreadBuffer()
+    {
+        auto buffer = new ThreadBuffer{.threadId = GetCurrentThreadId(), .next = buffers_.load(std::memory_order_relaxed)};
+        while (!buffers_.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+        return buffer;
+    }
+
+    static inline std::atomic<ThreadBuffer*> buffers_;
+};
+
+#define TRACE_SCOPE(name) const Tracer::Scope CONCATENATE(traceScope, __LINE__)(name)
+
+#else // !RAWINPUTVIEWER_ENABLE_TRACING
+
+#define TRACE_SCOPE(name) ((void)0)
+
+#endif // RAWINPUTVIEWER_ENABLE_TRACING
@@ -0,0 +1,831 @@
+/***************************************************************************************************
+ *
+ *   RawInputViewer - A utility to test, visualize, and map WM_INPUT messages.
+ *
+ *   Copyright (c) 2025 by Bitdancer (@RealBitdancer)
+ *
+ *   Licensed under the MIT License. See LICENSE file in the repository for details.
+ *
+ *   Source: https://github.com/RealBitdancer/RawInputViewer
+ *
+ **************************************************************************************************/
+
+// The parts of RawInputViewer.hpp that don't depend on Windows, so their tests build and run on any x86 platform.
+
+#pragma once
+
+#include <emmintrin.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+[[nodiscard]] inline uint64_t ticksToNanoseconds(int64_t ticks, int64_t frequency) noexcept
+{
+    // Split to avoid overflowing ticks * 10^9 for long durations
+    return static_cast<uint64_t>((ticks / frequency) * 1'000'000'000 + (ticks % frequency) * 1'000'000'000 / frequency);
+}
+
+// Calibrates the TSC frequency against a monotonic counter of known frequency. The Clock provides readTsc(),
+// readCounter(), counterFrequency() and hasInvariantTsc(); PerformanceCounter passes the CPU and
+// QueryPerformanceCounter(), tests pass a simulated one. If the TSC isn't invariant, or two measurements at startup
+// disagree, frequency() is the counter's.
+template<typename Clock>
+class TscCalibration
+{
+public:
+    static constexpr double tolerance = 1e-3; // Relative; far above the measurement error, far below a TSC gone wrong
+
+    TscCalibration(const TscCalibration&) = delete;
+    TscCalibration& operator=(const TscCalibration&) = delete;
+
+    explicit TscCalibration(Clock clock = {}) noexcept
+        : clock_{std::move(clock)}
+        , origin_{takeSample()}
+    {
+        // 10 ms bound the error of each measurement to about 10 ppm of a 10 MHz counter. A TSC that doesn't tick
+        // steadily after all, e.g. under some hypervisors, shows in the disagreement of two measurements.
+        if (clock_.hasInvariantTsc())
+        {
+            const Sample middle = takeSampleAfter(origin_, clock_.counterFrequency() / 100);
+            const Sample last = takeSampleAfter(middle, clock_.counterFrequency() / 100);
+            if (const int64_t first = measureFrequency(origin_, middle); first > 0 && isWithinTolerance(measureFrequency(middle, last), first))
+            {
+                isTsc_ = true;
+                frequency_.store(measureFrequency(origin_, last), std::memory_order_relaxed);
+                return;
+            }
+        }
+        frequency_.store(clock_.counterFrequency(), std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] bool isTsc() const noexcept
+    {
+        return isTsc_;
+    }
+
+    // Ticks per second of the TSC, or of the counter if the TSC isn't used
+    [[nodiscard]] int64_t frequency() const noexcept
+    {
+        return frequency_.load(std::memory_order_relaxed);
+    }
+
+    // Measures the TSC frequency again over the whole time since startup, so the estimate only gets better. Keeps
+    // the estimate when a sample doesn't advance or deviates beyond tolerance, e.g. after the TSC was reset on resume;
+    // ticks already taken can't switch to another clock.
+    void recalibrate() noexcept
+    {
+        if (isTsc_)
+        {
+            const Sample sample = takeSample();
+            if (sample.counter > origin_.counter && sample.tsc > origin_.tsc)
+            {
+                if (const int64_t measured = measureFrequency(origin_, sample); isWithinTolerance(measured, frequency()))
+                {
+                    frequency_.store(measured, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+private:
+    struct Sample
+    {
+        int64_t tsc;
+        int64_t counter;
+    };
+
+    // Brackets a counter read with TSC reads and keeps the tightest of a few tries, discarding those stretched by an
+    // interrupt
+    [[nodiscard]] Sample takeSample() noexcept
+    {
+        Sample best{};
+        uint64_t narrowest = std::numeric_limits<uint64_t>::max();
+        for (int i = 0; i < 16; ++i)
+        {
+            const uint64_t before = clock_.readTsc();
+            const int64_t counter = clock_.readCounter();
+            const uint64_t after = clock_.readTsc();
+            if (after - before < narrowest)
+            {
+                narrowest = after - before;
+                best = {static_cast<int64_t>(before + narrowest / 2), counter};
+            }
+        }
+        return best;
+    }
+
+    [[nodiscard]] Sample takeSampleAfter(const Sample& from, int64_t counterTicks) noexcept
+    {
+        Sample sample;
+        do
+        {
+            sample = takeSample();
+        } while (sample.counter - from.counter < counterTicks);
+        return sample;
+    }
+
+    [[nodiscard]] int64_t measureFrequency(const Sample& from, const Sample& to) const noexcept
+    {
+        const double seconds = static_cast<double>(to.counter - from.counter) / static_cast<double>(clock_.counterFrequency());
+        return std::llround(static_cast<double>(to.tsc - from.tsc) / seconds);
+    }
+
+    [[nodiscard]] static bool isWithinTolerance(int64_t measured, int64_t expected) noexcept
+    {
+        return measured > 0 && std::abs(static_cast<double>(measured - expected)) <= tolerance * static_cast<double>(expected);
+    }
+
+    Clock clock_;
+    const Sample origin_;
+    bool isTsc_{};
+    std::atomic<int64_t> frequency_;
+};
+
+// LEB128 variable length encoding of unsigned integers, used for compact serialization
+inline void appendVarUInt(std::vector<std::byte>& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<std::byte>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::byte>(value));
+}
+
+// Reads a value written by appendVarUInt() and advances in past it. Returns false if in is truncated or malformed.
+[[nodiscard]] inline bool readVarUInt(std::span<const std::byte>& in, uint64_t& value) noexcept
+{
+    value = 0;
+    for (unsigned shift = 0; shift < 64 && !in.empty(); shift += 7)
+    {
+        const auto byte = std::to_integer<uint64_t>(in.front());
+        in = in.subspan(1);
+        value |= (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Log-linear bucketed histogram in the style of HdrHistogram. Values below 2^MantissaBits are
+// counted exactly; larger values share a bucket with all values having the same MantissaBits
+// leading bits, which bounds the relative error to 2^-(MantissaBits - 1). Values of MaxValueBits
+// bits or more are counted in the last bucket. Memory is constant and recording is lock-free.
+template<unsigned MantissaBits = 7, unsigned MaxValueBits = 40>
+class Histogram
+{
+public:
+    static_assert(MantissaBits >= 2 && MantissaBits < MaxValueBits && MaxValueBits <= 64);
+
+    static constexpr size_t halfBucketCount = size_t{1} << (MantissaBits - 1);
+    static constexpr size_t bucketCount = (MaxValueBits - MantissaBits + 2) * halfBucketCount;
+    static constexpr double relativeError = 1.0 / static_cast<double>(halfBucketCount);
+
+    Histogram(const Histogram&) = delete;
+    Histogram& operator=(const Histogram&) = delete;
+
+    Histogram() noexcept = default;
+
+    void record(uint64_t value) noexcept
+    {
+        counts_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+
+        uint64_t min = min_.load(std::memory_order_relaxed);
+        while (value < min && !min_.compare_exchange_weak(min, value, std::memory_order_relaxed))
+        {
+        }
+
+        uint64_t max = max_.load(std::memory_order_relaxed);
+        while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void reset() noexcept
+    {
+        for (auto& count : counts_)
+        {
+            count.store(0, std::memory_order_relaxed);
+        }
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        min_.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    // Adds all values recorded by other; other may still be recording concurrently
+    void merge(const Histogram& other) noexcept
+    {
+        for (size_t i = 0; i < bucketCount; ++i)
+        {
+            if (const uint64_t count = other.counts_[i].load(std::memory_order_relaxed); count > 0)
+            {
+                counts_[i].fetch_add(count, std::memory_order_relaxed);
+            }
+        }
+        count_.fetch_add(other.count_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        sum_.fetch_add(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        const uint64_t otherMin = other.min_.load(std::memory_order_relaxed);
+        uint64_t min = min_.load(std::memory_order_relaxed);
+        while (otherMin < min && !min_.compare_exchange_weak(min, otherMin, std::memory_order_relaxed))
+        {
+        }
+
+        const uint64_t otherMax = other.max_.load(std::memory_order_relaxed);
+        uint64_t max = max_.load(std::memory_order_relaxed);
+        while (otherMax > max && !max_.compare_exchange_weak(max, otherMax, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    // Appends a sparse representation, which only stores non-empty buckets as
+    // (index delta, count) pairs. Typical distributions serialize to a few hundred bytes.
+    void serialize(std::vector<std::byte>& out) const
+    {
+        out.push_back(static_cast<std::byte>(MantissaBits));
+        out.push_back(static_cast<std::byte>(MaxValueBits));
+        appendVarUInt(out, count_.load(std::memory_order_relaxed));
+        appendVarUInt(out, sum_.load(std::memory_order_relaxed));
+        appendVarUInt(out, min());
+        appendVarUInt(out, max());
+
+        const auto nonEmpty = std::ranges::count_if(counts_, [](const auto& count) { return count.load(std::memory_order_relaxed) > 0; });
+        appendVarUInt(out, static_cast<uint64_t>(nonEmpty));
+
+        size_t previous = 0;
+        for (size_t i = 0; i < bucketCount; ++i)
+        {
+            if (const uint64_t count = counts_[i].load(std::memory_order_relaxed); count > 0)
+            {
+                appendVarUInt(out, i - previous);
+                appendVarUInt(out, count);
+                previous = i;
+            }
+        }
+    }
+
+    // Replaces the content with a histogram written by serialize() and advances in past it. Returns false,
+    // leaving the histogram empty, if the data is malformed or was written with different bucket parameters.
+    // Must not be called while other threads are recording.
+    [[nodiscard]] bool deserialize(std::span<const std::byte>& in) noexcept
+    {
+        reset();
+
+        if (in.size() < 2 || std::to_integer<unsigned>(in[0]) != MantissaBits || std::to_integer<unsigned>(in[1]) != MaxValueBits)
+        {
+            return false;
+        }
+        in = in.subspan(2);
+
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t min = 0;
+        uint64_t max = 0;
+        uint64_t nonEmpty = 0;
+        if (!readVarUInt(in, count) || !readVarUInt(in, sum) || !readVarUInt(in, min) || !readVarUInt(in, max) || !readVarUInt(in, nonEmpty))
+        {
+            return false;
+        }
+
+        uint64_t index = 0;
+        for (uint64_t i = 0; i < nonEmpty; ++i)
+        {
+            uint64_t delta = 0;
+            uint64_t countInBucket = 0;
+            if (!readVarUInt(in, delta) || !readVarUInt(in, countInBucket) || (index += delta) >= bucketCount)
+            {
+                reset();
+                return false;
+            }
+            counts_[static_cast<size_t>(index)].store(countInBucket, std::memory_order_relaxed);
+        }
+
+        count_.store(count, std::memory_order_relaxed);
+        sum_.store(sum, std::memory_order_relaxed);
+        min_.store(count > 0 ? min : std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+        max_.store(max, std::memory_order_relaxed);
+        return true;
+    }
+
+    [[nodiscard]] uint64_t count() const noexcept
+    {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint64_t min() const noexcept
+    {
+        return count() > 0 ? min_.load(std::memory_order_relaxed) : 0;
+    }
+
+    [[nodiscard]] uint64_t max() const noexcept
+    {
+        return max_.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] double mean() const noexcept
+    {
+        const uint64_t n = count();
+        return n > 0 ? static_cast<double>(sum_.load(std::memory_order_relaxed)) / static_cast<double>(n) : 0.0;
+    }
+
+    // Returns a value (within the error bound) that percentile percent of all recorded values are less than or equal to
+    [[nodiscard]] uint64_t valueAtPercentile(double percentile) const noexcept
+    {
+        const uint64_t n = count();
+        if (n == 0)
+        {
+            return 0;
+        }
+
+        if (percentile >= 100.0)
+        {
+            return max();
+        }
+
+        const double clamped = std::max(percentile, 0.0);
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(n))));
+
+        uint64_t accumulated = 0;
+        for (size_t i = 0; i < bucketCount; ++i)
+        {
+            accumulated += counts_[i].load(std::memory_order_relaxed);
+            if (accumulated >= rank)
+            {
+                return std::clamp((lowestValueOf(i) + highestValueOf(i)) / 2, min(), max());
+            }
+        }
+
+        return max();
+    }
+
+protected:
+    [[nodiscard]] static constexpr size_t bucketIndex(uint64_t value) noexcept
+    {
+        const unsigned width = static_cast<unsigned>(std::bit_width(value));
+        if (width <= MantissaBits)
+        {
+            return static_cast<size_t>(value);
+        }
+        if (width > MaxValueBits)
+        {
+            return bucketCount - 1;
+        }
+
+        const unsigned exponent = width - MantissaBits;
+        return exponent * halfBucketCount + static_cast<size_t>(value >> exponent);
+    }
+
+    [[nodiscard]] static constexpr uint64_t lowestValueOf(size_t index) noexcept
+    {
+        if (index < 2 * halfBucketCount)
+        {
+            return index;
+        }
+
+        const size_t exponent = index / halfBucketCount - 1;
+        return static_cast<uint64_t>(index - exponent * halfBucketCount) << exponent;
+    }
+
+    [[nodiscard]] static constexpr uint64_t highestValueOf(size_t index) noexcept
+    {
+        return index + 1 < bucketCount ? lowestValueOf(index + 1) - 1 : std::numeric_limits<uint64_t>::max();
+    }
+
+    std::array<std::atomic<uint64_t>, bucketCount> counts_{};
+    std::atomic<uint64_t> count_{};
+    std::atomic<uint64_t> sum_{};
+    std::atomic<uint64_t> min_{std::numeric_limits<uint64_t>::max()};
+    std::atomic<uint64_t> max_{};
+};
+
+// Kernels of AbsoluteMouseNormalizer. Absolute coordinates span 0..absoluteMaximum over the primary monitor, or over
+// the virtual desktop with flagVirtualDesktop. Positions are kept per device index; the first absolute event of a
+// device establishes its position and moves by zero.
+class AbsoluteMotion
+{
+public:
+    static constexpr int32_t absoluteMaximum = 65535;
+    static constexpr uint16_t flagMoveAbsolute = 0x01;   // MOUSE_MOVE_ABSOLUTE
+    static constexpr uint16_t flagVirtualDesktop = 0x02; // MOUSE_VIRTUAL_DESKTOP
+
+    struct Screen
+    {
+        int32_t left;
+        int32_t top;
+        int32_t width;
+        int32_t height;
+    };
+
+    // Writes the pixel positions of absolute events, four events at a time. Relative events already hold their
+    // motion and are written back unchanged.
+    static void toPixels(const int32_t* dx, const int32_t* dy, const uint16_t* flags, size_t count, const Screen& primary, const Screen& desktop, int32_t* positionX, int32_t* positionY) noexcept
+    {
+        const __m128i absoluteFlag = _mm_set1_epi32(flagMoveAbsolute);
+        const __m128i virtualDesktopFlag = _mm_set1_epi32(flagVirtualDesktop);
+        const __m128 primaryScaleX = _mm_set1_ps(static_cast<float>(primary.width - 1) / absoluteMaximum);
+        const __m128 primaryScaleY = _mm_set1_ps(static_cast<float>(primary.height - 1) / absoluteMaximum);
+        const __m128 desktopScaleX = _mm_set1_ps(static_cast<float>(desktop.width - 1) / absoluteMaximum);
+        const __m128 desktopScaleY = _mm_set1_ps(static_cast<float>(desktop.height - 1) / absoluteMaximum);
+        const __m128 primaryLeft = _mm_set1_ps(static_cast<float>(primary.left));
+        const __m128 primaryTop = _mm_set1_ps(static_cast<float>(primary.top));
+        const __m128 desktopLeft = _mm_set1_ps(static_cast<float>(desktop.left));
+        const __m128 desktopTop = _mm_set1_ps(static_cast<float>(desktop.top));
+        auto select = [](__m128 mask, __m128 a, __m128 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); };
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128i flags4 = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(flags + i)), _mm_setzero_si128());
+            const __m128i absolute = _mm_cmpeq_epi32(_mm_and_si128(flags4, absoluteFlag), absoluteFlag);
+            if (_mm_movemask_epi8(absolute) == 0)
+            {
+                continue;
+            }
+
+            const __m128 virtualDesktop = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(flags4, virtualDesktopFlag), virtualDesktopFlag));
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dx + i));
+            const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dy + i));
+            const __m128 scaledX = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(x), select(virtualDesktop, desktopScaleX, primaryScaleX)), select(virtualDesktop, desktopLeft, primaryLeft));
+            const __m128 scaledY = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(y), select(virtualDesktop, desktopScaleY, primaryScaleY)), select(virtualDesktop, desktopTop, primaryTop));
+            const __m128i pixelX = _mm_or_si128(_mm_and_si128(absolute, _mm_cvtps_epi32(scaledX)), _mm_andnot_si128(absolute, x));
+            const __m128i pixelY = _mm_or_si128(_mm_and_si128(absolute, _mm_cvtps_epi32(scaledY)), _mm_andnot_si128(absolute, y));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(positionX + i), pixelX);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(positionY + i), pixelY);
+        }
+
+        for (; i < count; ++i)
+        {
+            if ((flags[i] & flagMoveAbsolute) != 0)
+            {
+                const Screen& screen = (flags[i] & flagVirtualDesktop) != 0 ? desktop : primary;
+                // Same single-precision arithmetic and rounding as the vector loop
+                positionX[i] = static_cast<int32_t>(std::lrint(static_cast<float>(dx[i]) * (static_cast<float>(screen.width - 1) / absoluteMaximum) + static_cast<float>(screen.left)));
+                positionY[i] = static_cast<int32_t>(std::lrint(static_cast<float>(dy[i]) * (static_cast<float>(screen.height - 1) / absoluteMaximum) + static_cast<float>(screen.top)));
+            }
+        }
+    }
+
+    // Replaces pixel positions with the motion since the device's previous absolute event
+    void toRelative(int32_t* dx, int32_t* dy, const uint16_t* flags, const uint8_t* devices, size_t count) noexcept
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if ((flags[i] & flagMoveAbsolute) != 0)
+            {
+                Position& previous = positions_[devices[i]];
+                const Position position{dx[i], dy[i]};
+                dx[i] = previous.x != unknownPosition.x ? position.x - previous.x : 0;
+                dy[i] = previous.x != unknownPosition.x ? position.y - previous.y : 0;
+                previous = position;
+            }
+        }
+    }
+
+    void reset() noexcept
+    {
+        positions_.fill(unknownPosition);
+    }
+
+    // The device's next absolute event establishes its position again, e.g. after its index went to another device
+    void forget(uint8_t device) noexcept
+    {
+        positions_[device] = unknownPosition;
+    }
+
+private:
+    struct Position
+    {
+        int32_t x;
+        int32_t y;
+    };
+
+    static constexpr Position unknownPosition{std::numeric_limits<int32_t>::min(), 0};
+
+    std::array<Position, 256> positions_ = []
+    {
+        std::array<Position, 256> positions;
+        positions.fill(unknownPosition);
+        return positions;
+    }();
+};
+
+// Input field of a HID report. Bit offsets count from the start of the report, including the report ID byte if
+// reports have one. Array fields hold the index of a pressed usage rather than a value.
+struct HidField
+{
+    uint16_t usagePage;
+    uint16_t usage;
+    uint8_t reportId;
+    bool isArray;
+    uint8_t bitSize;
+    uint32_t bitOffset;
+    int32_t logicalMinimum;
+    int32_t logicalMaximum;
+};
+
+// Fields of a report descriptor compiled into byte offsets, shifts and masks, so extracting a report is a fixed
+// sequence of loads without interpreting the descriptor again. Fields are ordered by report ID and bit offset, and
+// values are indexed like fields.
+class HidExtractionPlan
+{
+public:
+    static constexpr size_t maxFields = 4096; // Guards against devices with absurd report counts
+
+    // Indexes of the fields of a report
+    struct Range
+    {
+        size_t first;
+        size_t last;
+    };
+
+    HidExtractionPlan() noexcept = default;
+
+    explicit HidExtractionPlan(std::vector<HidField> fields)
+        : fields_{std::move(fields)}
+    {
+        std::ranges::stable_sort(fields_, [](const HidField& a, const HidField& b) { return std::tie(a.reportId, a.bitOffset) < std::tie(b.reportId, b.bitOffset); });
+
+        steps_.reserve(fields_.size());
+        for (const HidField& field : fields_)
+        {
+            const uint8_t shift = static_cast<uint8_t>(field.bitOffset % 8);
+            // clang-format off
+            steps_.push_back(
+            {
+                .byteOffset = field.bitOffset / 8,
+                .byteCount = static_cast<uint8_t>((shift + field.bitSize + 7) / 8),
+                .shift = shift,
+                .signShift = static_cast<uint8_t>(field.logicalMinimum < 0 ? 32 - field.bitSize : 0),
+                .mask = field.bitSize < 32 ? (1u << field.bitSize) - 1 : ~0u
+            });
+            // clang-format on
+            usesReportIds_ |= field.reportId != 0;
+        }
+
+        // firstField_[id]..firstField_[id + 1] are the fields of report ID id
+        for (size_t id = 0, i = 0; id < firstField_.size(); ++id)
+        {
+            while (i < fields_.size() && fields_[i].reportId < id)
+            {
+                ++i;
+            }
+            firstField_[id] = static_cast<uint32_t>(i);
+        }
+    }
+
+    [[nodiscard]] std::span<const HidField> fields() const noexcept
+    {
+        return fields_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return fields_.empty();
+    }
+
+    // Extracts the fields of the report into values and returns their indexes; values of other reports are left as
+    // they are. Fields beyond the end of a short report are skipped.
+    Range extract(std::span<const uint8_t> report, std::span<int32_t> values) const noexcept
+    {
+        assert(values.size() >= fields_.size());
+        const uint8_t reportId = usesReportIds_ && !report.empty() ? report[0] : 0;
+        const Range range{firstField_[reportId], firstField_[reportId + 1]};
+        for (size_t i = range.first; i < range.last; ++i)
+        {
+            const Step& step = steps_[i];
+            if (step.byteOffset + step.byteCount > report.size())
+            {
+                continue;
+            }
+
+            // Fields span at most five bytes; reports are little-endian just like x86 and x64
+            uint64_t bits = 0;
+            std::memcpy(&bits, report.data() + step.byteOffset, step.byteCount);
+            const uint32_t value = static_cast<uint32_t>(bits >> step.shift) & step.mask;
+            values[i] = static_cast<int32_t>(value << step.signShift) >> step.signShift;
+        }
+        return range;
+    }
+
+private:
+    struct Step
+    {
+        uint32_t byteOffset;
+        uint8_t byteCount;
+        uint8_t shift;
+        uint8_t signShift; // Sign-extends fields with a negative logical minimum
+        uint32_t mask;
+    };
+
+    std::vector<HidField> fields_;
+    std::vector<Step> steps_;
+    std::array<uint32_t, 257> firstField_{};
+    bool usesReportIds_{};
+};
+
+// Parses the input items of a HID report descriptor (HID 1.11, section 6.2.2) into an extraction plan. Output and
+// feature reports, long items, and delimiters are skipped. Raw input doesn't hand out descriptors, so on Windows plans
+// come from compileHidExtractionPlan(); this is for descriptors read elsewhere, e.g. from Linux hidraw.
+class HidDescriptorParser
+{
+public:
+    // With reportIdPrefix, reports start with a report ID byte even if the descriptor doesn't declare report IDs,
+    // which is how Windows delivers them
+    [[nodiscard]] static HidExtractionPlan compile(std::span<const uint8_t> descriptor, bool reportIdPrefix = false)
+    {
+        Globals globals;
+        std::vector<Globals> globalsStack;
+        std::vector<uint32_t> usages;
+        uint32_t usageMinimum = 0;
+        uint32_t usageMaximum = 0;
+        bool hasUsageRange = false;
+        std::array<uint32_t, 256> bitOffsets;
+        bitOffsets.fill(noOffset);
+        std::vector<HidField> fields;
+
+        for (size_t i = 0; i < descriptor.size();)
+        {
+            const uint8_t prefix = descriptor[i];
+            if (prefix == longItemPrefix)
+            {
+                i += i + 1 < descriptor.size() ? 3 + descriptor[i + 1] : descriptor.size();
+                continue;
+            }
+
+            const size_t dataSize = (prefix & 3) == 3 ? 4 : prefix & 3;
+            if (i + 1 + dataSize > descriptor.size())
+            {
+                break;
+            }
+
+            uint32_t data = 0;
+            for (size_t k = 0; k < dataSize; ++k)
+            {
+                data |= static_cast<uint32_t>(descriptor[i + 1 + k]) << (8 * k);
+            }
+            const int32_t signedData = dataSize != 0 && dataSize < 4 ? static_cast<int32_t>(data << (32 - 8 * dataSize)) >> (32 - 8 * dataSize) : static_cast<int32_t>(data);
+            // Local usages of four bytes carry their own usage page
+            const uint32_t extendedUsage = dataSize == 4 ? data : (static_cast<uint32_t>(globals.usagePage) << 16) | data;
+            i += 1 + dataSize;
+
+            switch (prefix & 0xfc)
+            {
+                case 0x80: // Input
+                {
+                    uint32_t& bitOffset = bitOffsets[globals.reportId];
+                    if (bitOffset == noOffset)
+                    {
+                        bitOffset = globals.reportId != 0 || reportIdPrefix ? 8 : 0;
+                    }
+
+                    const bool isConstant = (data & 0x01) != 0;
+                    const bool isVariable = (data & 0x02) != 0;
+                    if (!isConstant && globals.reportSize >= 1 && globals.reportSize <= 32)
+                    {
+                        for (uint32_t n = 0; n < globals.reportCount && fields.size() < HidExtractionPlan::maxFields; ++n)
+                        {
+                            uint32_t usage = 0;
+                            if (!isVariable)
+                            {
+                                usage = hasUsageRange ? usageMinimum : (usages.empty() ? 0 : usages.front());
+                            }
+                            else if (n < usages.size())
+                            {
+                                usage = usages[n];
+                            }
+                            else if (hasUsageRange)
+                            {
+                                usage = std::min(usageMinimum + (n - static_cast<uint32_t>(usages.size())), usageMaximum);
+                            }
+                            else if (!usages.empty())
+                            {
+                                usage = usages.back();
+                            }
+
+                            // clang-format off
+                            fields.push_back(
+                            {
+                                .usagePage = static_cast<uint16_t>(usage >> 16),
+                                .usage = static_cast<uint16_t>(usage),
+                                .reportId = globals.reportId,
+                                .isArray = !isVariable,
+                                .bitSize = static_cast<uint8_t>(globals.reportSize),
+                                .bitOffset = bitOffset + n * globals.reportSize,
+                                .logicalMinimum = globals.logicalMinimum,
+                                .logicalMaximum = globals.logicalMaximum
+                            });
+                            // clang-format on
+                        }
+                    }
+                    bitOffset += globals.reportSize * globals.reportCount;
+                    [[fallthrough]];
+                }
+                case 0x90: // Output
+                case 0xb0: // Feature
+                case 0xa0: // Collection
+                case 0xc0: // End Collection
+                {
+                    // Main items consume the local items
+                    usages.clear();
+                    hasUsageRange = false;
+                    break;
+                }
+                case 0x04: // Usage Page
+                {
+                    globals.usagePage = static_cast<uint16_t>(data);
+                    break;
+                }
+                case 0x14: // Logical Minimum
+                {
+                    globals.logicalMinimum = signedData;
+                    break;
+                }
+                case 0x24: // Logical Maximum
+                {
+                    // Devices often encode e.g. 255 in a single byte, which only makes sense unsigned
+                    globals.logicalMaximum = signedData < globals.logicalMinimum ? static_cast<int32_t>(data) : signedData;
+                    break;
+                }
+                case 0x74: // Report Size
+                {
+                    globals.reportSize = data;
+                    break;
+                }
+                case 0x84: // Report ID
+                {
+                    globals.reportId = static_cast<uint8_t>(data);
+                    break;
+                }
+                case 0x94: // Report Count
+                {
+                    globals.reportCount = data;
+                    break;
+                }
+                case 0xa4: // Push
+                {
+                    globalsStack.push_back(globals);
+                    break;
+                }
+                case 0xb4: // Pop
+                {
+                    if (!globalsStack.empty())
+                    {
+                        globals = globalsStack.back();
+                        globalsStack.pop_back();
+                    }
+                    break;
+                }
+                case 0x08: // Usage
+                {
+                    usages.push_back(extendedUsage);
+                    break;
+                }
+                case 0x18: // Usage Minimum
+                {
+                    usageMinimum = extendedUsage;
+                    hasUsageRange = true;
+                    break;
+                }
+                case 0x28: // Usage Maximum
+                {
+                    usageMaximum = extendedUsage;
+                    hasUsageRange = true;
+                    break;
+                }
+            }
+        }
+
+        return HidExtractionPlan(std::move(fields));
+    }
+
+private:
+    static constexpr uint8_t longItemPrefix = 0xfe;
+    static constexpr uint32_t noOffset = ~0u;
+
+    struct Globals
+    {
+        uint16_t usagePage{};
+        uint8_t reportId{};
+        int32_t logicalMinimum{};
+        int32_t logicalMaximum{};
+        uint32_t reportSize{};
+        uint32_t reportCount{};
+    };
+};
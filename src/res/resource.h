@@ -12,6 +12,73 @@
 #define IDS_TOOLTIP_ADJUST              107
 #define IDS_STATUS_BAR_HELP_TEXT        108
 #define IDS_NA                          109
+#define IDS_SYSMENU_SAVE_TRACE          110
+#define IDS_FILE_SAVED                  111
+#define IDS_FILE_SAVE_FAILED            112
+#define IDS_STATUS_BAR_METRICS          113
+#define IDS_SYSMENU_STATISTICS          114
+#define IDS_REPORT_DISTRIBUTION         115
+#define IDS_REPORT_LATENCY              116
+#define IDS_REPORT_KEYBOARD_INTERVALS   117
+#define IDS_REPORT_MOUSE_INTERVALS      118
+#define IDS_REPORT_KEYBOARD_COUNTERS    119
+#define IDS_REPORT_HOLD_COUNTERS        120
+#define IDS_REPORT_HOLD_DURATIONS       121
+#define IDS_REPORT_KEY_HOLD             122
+#define IDS_SYSMENU_CHATTER_WINDOW      123
+#define IDS_SYSMENU_CHATTER_WINDOW_ITEM 124
+#define IDS_REPORT_CHATTER              125
+#define IDS_REPORT_KEY_CHATTER          126
+#define IDS_REPORT_ROLLOVER             127
+#define IDS_REPORT_CHORD                128
+#define IDS_REPORT_BLOCKED_KEY          129
+#define IDS_REPORT_POLLING              130
+#define IDS_DEVICE_KEYBOARD             131
+#define IDS_DEVICE_MOUSE                132
+#define IDS_MOUSE_COLUMNS               133
+#define IDS_SYSMENU_MOUSE_EVENTS        134
+#define IDS_REPORT_MOUSE                135
+#define IDS_REPORT_MOUSE_MOTION         136
+#define IDS_REPORT_MOUSE_CALIBRATION    137
+#define IDS_REPORT_MOUSE_BALLISTICS     138
+#define IDS_BALLISTICS_NONE             139
+#define IDS_BALLISTICS_WINDOWS          140
+#define IDS_BALLISTICS_LIBINPUT         141
+#define IDS_REPORT_WHEEL                142
+#define IDS_WHEEL_VERTICAL              143
+#define IDS_WHEEL_HORIZONTAL            144
+#define IDS_SYSMENU_CAPTURE_HID         145
+#define IDS_REPORT_HID                  146
+#define IDS_REPORT_HID_FIELD            147
+#define IDS_REPORT_GAMEPAD_AXIS         148
+#define IDS_DEVICE_HID                  149
+#define IDS_REPORT_DEVICE               150
+#define IDS_DEVICE_CONNECTED            151
+#define IDS_DEVICE_DISCONNECTED         152
+#define IDS_REPORT_DEVICE_ARRIVAL       153
+#define IDS_REPORT_DEVICE_REMOVAL       154
+#define IDS_SYSMENU_SAVE_TIMELINE       155
+#define IDS_TIMELINE_MERGED             156
+#define IDS_SYSMENU_THREADED_CAPTURE    157
+#define IDS_SYSMENU_CAPTURE_THREAD      158
+#define IDS_SYSMENU_CAPTURE_ANY_CORE    159
+#define IDS_SYSMENU_CAPTURE_CORE        160
+#define IDS_SYSMENU_CAPTURE_PRIORITY    161
+#define IDS_SYSMENU_CAPTURE_BUSY_POLL   162
+#define IDS_REPORT_CAPTURE_THREAD       163
+#define IDS_CAPTURE_CORE                164
+#define IDS_CAPTURE_ANY_CORE            165
+#define IDS_CAPTURE_TIME_CRITICAL       166
+#define IDS_CAPTURE_NORMAL_PRIORITY     167
+#define IDS_CAPTURE_BUSY_POLL           168
+#define IDS_CAPTURE_WAITING             169
+#define IDS_REPORT_CLOCK_TSC            170
+#define IDS_REPORT_CLOCK_QPC            171
+#define IDS_REPORT_SOURCE_LATENCY       172
+#define IDS_SYSMENU_FLIGHT_RECORDER     173
+#define IDS_SYSMENU_DUMP_FLIGHT_RECORDER 174
+#define IDS_REPORT_FLIGHT_RECORDER      175
+#define IDS_REPORT_ANOMALIES            176
 #define ID_VIRTUAL_KEY_MAPPING          1001
 #define ID_SCANCODE_MAPPING             1002
 #define ID_TOOLBAR                      1003
@@ -32,6 +99,18 @@
 #define IDC_POPUP_SML                   1301
 #define IDC_POPUP_RAY                   1302
 #define IDC_POPUP_GLFW                  1303
+#define ID_SYSMENU_SAVE_TRACE           2000
+#define ID_SYSMENU_STATISTICS           2016
+#define ID_SYSMENU_CHATTER_WINDOW       2032
+#define ID_SYSMENU_MOUSE_EVENTS         2112
+#define ID_SYSMENU_CAPTURE_HID          2128
+#define ID_SYSMENU_SAVE_TIMELINE        2144
+#define ID_SYSMENU_THREADED_CAPTURE     2160
+#define ID_SYSMENU_CAPTURE_PRIORITY     2176
+#define ID_SYSMENU_CAPTURE_BUSY_POLL    2192
+#define ID_SYSMENU_CAPTURE_CORE         2208
+#define ID_SYSMENU_FLIGHT_RECORDER      3248
+#define ID_SYSMENU_DUMP_FLIGHT_RECORDER 3264
 #define IDC_STATIC                      -1
 
 // Next default values for new objects
@@ -42,6 +121,6 @@
 #define _APS_NEXT_RESOURCE_VALUE        136
 #define _APS_NEXT_COMMAND_VALUE         32772
 #define _APS_NEXT_CONTROL_VALUE         1000
-#define _APS_NEXT_SYMED_VALUE           110
+#define _APS_NEXT_SYMED_VALUE           177
 #endif
 #endif
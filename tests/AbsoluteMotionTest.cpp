@@ -0,0 +1,166 @@
+/***************************************************************************************************
+ *
+ *   RawInputViewer - A utility to test, visualize, and map WM_INPUT messages.
+ *
+ *   Copyright (c) 2025 by Bitdancer (@RealBitdancer)
+ *
+ *   Licensed under the MIT License. See LICENSE file in the repository for details.
+ *
+ *   Source: https://github.com/RealBitdancer/RawInputViewer
+ *
+ **************************************************************************************************/
+
+// Runs the AbsoluteMotion kernels over synthetic captures mixing relative mice with absolute pointers on the
+// primary monitor and on the virtual desktop, and checks the pixel positions and the motion against a scalar
+// reference. Builds without Windows.
+
+#include "RawInputViewerCore.hpp"
+#include "Check.hpp"
+
+#include <optional>
+#include <utility>
+
+namespace
+{
+    using Screen = AbsoluteMotion::Screen;
+
+    constexpr Screen primary{0, 0, 1920, 1080};
+    constexpr Screen desktop{-1920, -200, 3840, 1280};
+
+    // Columns as MouseEventStore keeps them
+    struct Capture
+    {
+        std::vector<int32_t> x;
+        std::vector<int32_t> y;
+        std::vector<uint16_t> flags;
+        std::vector<uint8_t> devices;
+    };
+
+    // Device 0 is a relative mouse, device 1 a tablet on the primary monitor, device 2 a remote desktop session
+    // spanning the virtual desktop
+    Capture makeCapture(size_t count)
+    {
+        Capture capture;
+        uint32_t seed = 12345;
+        auto random = [&seed] { return (seed = seed * 1664525 + 1013904223) >> 8; };
+        for (size_t i = 0; i < count; ++i)
+        {
+            const uint8_t device = static_cast<uint8_t>(random() % 3);
+            capture.devices.push_back(device);
+            if (device == 0)
+            {
+                capture.x.push_back(static_cast<int32_t>(random() % 41) - 20);
+                capture.y.push_back(static_cast<int32_t>(random() % 41) - 20);
+                capture.flags.push_back(0);
+            }
+            else
+            {
+                capture.x.push_back(static_cast<int32_t>(random() % (AbsoluteMotion::absoluteMaximum + 1)));
+                capture.y.push_back(static_cast<int32_t>(random() % (AbsoluteMotion::absoluteMaximum + 1)));
+                capture.flags.push_back(AbsoluteMotion::flagMoveAbsolute | (device == 2 ? AbsoluteMotion::flagVirtualDesktop : 0));
+            }
+        }
+        return capture;
+    }
+
+    int32_t toPixel(int32_t absolute, int32_t origin, int32_t extent)
+    {
+        return static_cast<int32_t>(std::lrint(static_cast<float>(absolute) * (static_cast<float>(extent - 1) / AbsoluteMotion::absoluteMaximum) + static_cast<float>(origin)));
+    }
+
+    // Expected motion of each event, the first absolute event of a device doesn't move
+    std::vector<std::pair<int32_t, int32_t>> referenceMotion(const Capture& capture, size_t first, size_t last)
+    {
+        std::vector<std::pair<int32_t, int32_t>> motion;
+        std::array<std::optional<std::pair<int32_t, int32_t>>, 3> positions;
+        for (size_t i = first; i < last; ++i)
+        {
+            if ((capture.flags[i] & AbsoluteMotion::flagMoveAbsolute) == 0)
+            {
+                motion.emplace_back(capture.x[i], capture.y[i]);
+                continue;
+            }
+
+            const Screen& screen = (capture.flags[i] & AbsoluteMotion::flagVirtualDesktop) != 0 ? desktop : primary;
+            const std::pair position{toPixel(capture.x[i], screen.left, screen.width), toPixel(capture.y[i], screen.top, screen.height)};
+            std::optional<std::pair<int32_t, int32_t>>& previous = positions[capture.devices[i]];
+            motion.emplace_back(previous ? position.first - previous->first : 0, previous ? position.second - previous->second : 0);
+            previous = position;
+        }
+        return motion;
+    }
+
+    // Normalizes capture[first, last) in batches of batchSize and returns the mismatches against expected
+    size_t countMismatches(AbsoluteMotion& motion, const Capture& capture, size_t first, size_t last, size_t batchSize, const std::vector<std::pair<int32_t, int32_t>>& expected)
+    {
+        // Relative events hold their motion already, as the store's motion columns do
+        std::vector<int32_t> x = capture.x;
+        std::vector<int32_t> y = capture.y;
+        for (size_t i = first; i < last; i += batchSize)
+        {
+            const size_t count = std::min(batchSize, last - i);
+            AbsoluteMotion::toPixels(&capture.x[i], &capture.y[i], &capture.flags[i], count, primary, desktop, &x[i], &y[i]);
+            motion.toRelative(&x[i], &y[i], &capture.flags[i], &capture.devices[i], count);
+        }
+
+        size_t mismatches = 0;
+        for (size_t i = first; i < last; ++i)
+        {
+            mismatches += x[i] != expected[i - first].first || y[i] != expected[i - first].second ? 1 : 0;
+        }
+        return mismatches;
+    }
+} // namespace
+
+int main()
+{
+    const Capture capture = makeCapture(10'003);
+    const std::vector<std::pair<int32_t, int32_t>> motion = referenceMotion(capture, 0, capture.x.size());
+
+    // All at once, and in batches of odd sizes that leave scalar tails and split vector blocks
+    for (const size_t batchSize : {capture.x.size(), size_t{1}, size_t{3}, size_t{4097}})
+    {
+        AbsoluteMotion absoluteMotion;
+        CHECK(countMismatches(absoluteMotion, capture, 0, capture.x.size(), batchSize, motion) == 0);
+    }
+
+    // The corners of both screens map to their first and last pixels
+    {
+        const std::array<int32_t, 4> x{0, AbsoluteMotion::absoluteMaximum, 0, AbsoluteMotion::absoluteMaximum};
+        const std::array<int32_t, 4> y{0, AbsoluteMotion::absoluteMaximum, 0, AbsoluteMotion::absoluteMaximum};
+        const std::array<uint16_t, 4> flags{AbsoluteMotion::flagMoveAbsolute, AbsoluteMotion::flagMoveAbsolute, AbsoluteMotion::flagMoveAbsolute | AbsoluteMotion::flagVirtualDesktop,
+            AbsoluteMotion::flagMoveAbsolute | AbsoluteMotion::flagVirtualDesktop};
+        std::array<int32_t, 4> pixelX{};
+        std::array<int32_t, 4> pixelY{};
+        AbsoluteMotion::toPixels(x.data(), y.data(), flags.data(), x.size(), primary, desktop, pixelX.data(), pixelY.data());
+        CHECK(pixelX[0] == 0 && pixelY[0] == 0);
+        CHECK(pixelX[1] == primary.width - 1 && pixelY[1] == primary.height - 1);
+        CHECK(pixelX[2] == desktop.left && pixelY[2] == desktop.top);
+        CHECK(pixelX[3] == desktop.left + desktop.width - 1 && pixelY[3] == desktop.top + desktop.height - 1);
+    }
+
+    // After a reset, each device's next absolute event starts over
+    {
+        AbsoluteMotion absoluteMotion;
+        const size_t half = capture.x.size() / 2;
+        CHECK(countMismatches(absoluteMotion, capture, 0, half, 64, motion) == 0);
+        absoluteMotion.reset();
+        CHECK(countMismatches(absoluteMotion, capture, half, capture.x.size(), 64, referenceMotion(capture, half, capture.x.size())) == 0);
+    }
+
+    // A forgotten device starts over, the others keep their positions
+    {
+        AbsoluteMotion absoluteMotion;
+        std::array<int32_t, 4> x{100, 200, 110, 210};
+        std::array<int32_t, 4> y{50, 60, 55, 65};
+        const std::array<uint16_t, 4> flags{AbsoluteMotion::flagMoveAbsolute, AbsoluteMotion::flagMoveAbsolute, AbsoluteMotion::flagMoveAbsolute, AbsoluteMotion::flagMoveAbsolute};
+        const std::array<uint8_t, 4> devices{1, 2, 1, 2};
+        absoluteMotion.toRelative(x.data(), y.data(), flags.data(), devices.data(), 2);
+        absoluteMotion.forget(1);
+        absoluteMotion.toRelative(&x[2], &y[2], &flags[2], &devices[2], 2);
+        CHECK(x[2] == 0 && y[2] == 0);
+        CHECK(x[3] == 10 && y[3] == 5);
+    }
+
+    return checkResult();
+}
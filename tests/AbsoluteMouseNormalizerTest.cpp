@@ -0,0 +1,184 @@
+/***************************************************************************************************
+ *
+ *   RawInputViewer - A utility to test, visualize, and map WM_INPUT messages.
+ *
+ *   Copyright (c) 2025 by Bitdancer (@RealBitdancer)
+ *
+ *   Licensed under the MIT License. See LICENSE file in the repository for details.
+ *
+ *   Source: https://github.com/RealBitdancer/RawInputViewer
+ *
+ **************************************************************************************************/
+
+// Normalizes synthetic captures mixing relative mice with absolute pointers on the primary monitor and on the
+// virtual desktop, and checks the motion columns against a scalar reference while the raw columns stay as received.
+
+#include "RawInputViewer.hpp"
+#include "Check.hpp"
+
+namespace
+{
+    using Screen = AbsoluteMouseNormalizer::Screen;
+
+    constexpr Screen primary{0, 0, 1920, 1080};
+    constexpr Screen desktop{-1920, -200, 3840, 1280};
+
+    struct Event
+    {
+        uint8_t device;
+        RAWMOUSE mouse;
+    };
+
+    // Device 0 is a relative mouse, device 1 a tablet on the primary monitor, device 2 a remote desktop session
+    // spanning the virtual desktop
+    std::vector<Event> makeCapture(size_t count)
+    {
+        std::vector<Event> events;
+        uint32_t seed = 12345;
+        auto random = [&seed] { return (seed = seed * 1664525 + 1013904223) >> 8; };
+        for (size_t i = 0; i < count; ++i)
+        {
+            const uint8_t device = static_cast<uint8_t>(random() % 3);
+            RAWMOUSE mouse{};
+            if (device == 0)
+            {
+                mouse.lLastX = static_cast<LONG>(random() % 41) - 20;
+                mouse.lLastY = static_cast<LONG>(random() % 41) - 20;
+            }
+            else
+            {
+                mouse.usFlags = MOUSE_MOVE_ABSOLUTE | (device == 2 ? MOUSE_VIRTUAL_DESKTOP : 0);
+                mouse.lLastX = static_cast<LONG>(random() % (AbsoluteMouseNormalizer::absoluteMaximum + 1));
+                mouse.lLastY = static_cast<LONG>(random() % (AbsoluteMouseNormalizer::absoluteMaximum + 1));
+            }
+            events.push_back({device, mouse});
+        }
+        return events;
+    }
+
+    int32_t toPixel(LONG absolute, int32_t origin, int32_t extent)
+    {
+        return static_cast<int32_t>(std::lrint(static_cast<float>(absolute) * (static_cast<float>(extent - 1) / AbsoluteMouseNormalizer::absoluteMaximum) + static_cast<float>(origin)));
+    }
+
+    // Expected motion of each event, the first absolute event of a device doesn't move
+    std::vector<std::pair<int32_t, int32_t>> referenceMotion(const std::vector<Event>& events)
+    {
+        std::vector<std::pair<int32_t, int32_t>> motion;
+        std::array<std::optional<std::pair<int32_t, int32_t>>, 3> positions;
+        for (const Event& event : events)
+        {
+            if ((event.mouse.usFlags & MOUSE_MOVE_ABSOLUTE) == 0)
+            {
+                motion.emplace_back(event.mouse.lLastX, event.mouse.lLastY);
+                continue;
+            }
+
+            const Screen& screen = (event.mouse.usFlags & MOUSE_VIRTUAL_DESKTOP) != 0 ? desktop : primary;
+            const std::pair position{toPixel(event.mouse.lLastX, screen.left, screen.width), toPixel(event.mouse.lLastY, screen.top, screen.height)};
+            std::optional<std::pair<int32_t, int32_t>>& previous = positions[event.device];
+            motion.emplace_back(previous ? position.first - previous->first : 0, previous ? position.second - previous->second : 0);
+            previous = position;
+        }
+        return motion;
+    }
+
+    void append(MouseEventStore& store, const std::vector<Event>& events, size_t first, size_t last)
+    {
+        for (size_t i = first; i < last; ++i)
+        {
+            store.append(events[i].device, events[i].mouse, static_cast<int64_t>(i + 1));
+        }
+    }
+
+    void checkStore(const MouseEventStore& store, const std::vector<Event>& events, const std::vector<std::pair<int32_t, int32_t>>& motion)
+    {
+        size_t rawMismatches = 0;
+        size_t motionMismatches = 0;
+        for (size_t i = 0; i < events.size(); ++i)
+        {
+            rawMismatches += store.dx[i] != events[i].mouse.lLastX || store.dy[i] != events[i].mouse.lLastY ? 1 : 0;
+            motionMismatches += store.motionX[i] != motion[i].first || store.motionY[i] != motion[i].second ? 1 : 0;
+        }
+        CHECK(rawMismatches == 0);
+        CHECK(motionMismatches == 0);
+    }
+} // namespace
+
+int main()
+{
+    // More than a chunk, with a partial vector block at the end
+    const std::vector<Event> events = makeCapture(MouseEventStore{}.dx.chunkSize + 1003);
+    const std::vector<std::pair<int32_t, int32_t>> motion = referenceMotion(events);
+
+    // All at once
+    {
+        MouseEventStore store;
+        AbsoluteMouseNormalizer normalizer;
+        append(store, events, 0, events.size());
+        normalizer.normalize(store, primary, desktop);
+        checkStore(store, events, motion);
+
+        // Normalizing again changes nothing
+        normalizer.normalize(store, primary, desktop);
+        checkStore(store, events, motion);
+    }
+
+    // In batches of odd sizes, as the metrics timer does while input arrives
+    {
+        MouseEventStore store;
+        AbsoluteMouseNormalizer normalizer;
+        for (size_t first = 0; first < events.size(); first += 4097)
+        {
+            append(store, events, first, std::min(first + 4097, events.size()));
+            normalizer.normalize(store, primary, desktop);
+        }
+        checkStore(store, events, motion);
+    }
+
+    // Skipped absolute events keep no motion and the next normalized event of each device starts over
+    {
+        MouseEventStore store;
+        AbsoluteMouseNormalizer normalizer;
+        const size_t half = events.size() / 2;
+        append(store, events, 0, half);
+        normalizer.skip(store);
+        append(store, events, half, events.size());
+        normalizer.normalize(store, primary, desktop);
+
+        const std::vector<Event> secondHalf(events.begin() + static_cast<ptrdiff_t>(half), events.end());
+        const std::vector<std::pair<int32_t, int32_t>> secondMotion = referenceMotion(secondHalf);
+        size_t mismatches = 0;
+        for (size_t i = 0; i < events.size(); ++i)
+        {
+            const bool isAbsolute = (events[i].mouse.usFlags & MOUSE_MOVE_ABSOLUTE) != 0;
+            const std::pair<int32_t, int32_t> relative{events[i].mouse.lLastX, events[i].mouse.lLastY};
+            const std::pair<int32_t, int32_t> expected = i >= half ? secondMotion[i - half] : isAbsolute ? std::pair{0, 0} : relative;
+            mismatches += store.motionX[i] != expected.first || store.motionY[i] != expected.second ? 1 : 0;
+        }
+        CHECK(mismatches == 0);
+    }
+
+    // Aggregates add up the motion, not the raw coordinates
+    {
+        MouseEventStore store;
+        AbsoluteMouseNormalizer normalizer;
+        append(store, events, 0, events.size());
+        normalizer.normalize(store, primary, desktop);
+        for (uint8_t device = 0; device < 3; ++device)
+        {
+            int64_t x = 0;
+            int64_t y = 0;
+            for (size_t i = 0; i < events.size(); ++i)
+            {
+                x += events[i].device == device ? motion[i].first : 0;
+                y += events[i].device == device ? motion[i].second : 0;
+            }
+            const MouseEventStore::Aggregates totals = store.aggregate(device);
+            CHECK(totals.x == x);
+            CHECK(totals.y == y);
+        }
+    }
+
+    return checkResult();
+}
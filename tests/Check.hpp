@@ -0,0 +1,35 @@
+/***************************************************************************************************
+ *
+ *   RawInputViewer - A utility to test, visualize, and map WM_INPUT messages.
+ *
+ *   Copyright (c) 2025 by Bitdancer (@RealBitdancer)
+ *
+ *   Licensed under the MIT License. See LICENSE file in the repository for details.
+ *
+ *   Source: https://github.com/RealBitdancer/RawInputViewer
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdio>
+
+// Minimal assertion support for the tests; a failed check is reported and fails the test, but
+// doesn't stop it, so one run shows every failure.
+inline int checkFailures = 0;
+
+#define CHECK(condition)                                                                          \
+    do                                                                                            \
+    {                                                                                             \
+        if (!(condition))                                                                         \
+        {                                                                                         \
+            std::fprintf(stderr, "%s(%d): CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            ++checkFailures;                                                                      \
+        }                                                                                         \
+    } while (false)
+
+[[nodiscard]] inline int checkResult()
+{
+    std::printf("%s\n", checkFailures == 0 ? "Passed" : "FAILED");
+    return checkFailures == 0 ? 0 : 1;
+}
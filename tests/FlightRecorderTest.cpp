@@ -0,0 +1,139 @@
+/***************************************************************************************************
+ *
+ *   RawInputViewer - A utility to test, visualize, and map WM_INPUT messages.
+ *
+ *   Copyright (c) 2025 by Bitdancer (@RealBitdancer)
+ *
+ *   Licensed under the MIT License. See LICENSE file in the repository for details.
+ *
+ *   Source: https://github.com/RealBitdancer/RawInputViewer
+ *
+ **************************************************************************************************/
+
+// Records synthetic keyboard and mouse events into a 1 MB FlightRecorder and checks the dumped CSV files: all events
+// of a short recording, the newest ring's worth of a long one, the anomaly hold-off, and the external trigger event
+// named after the process ID.
+
+#include "RawInputViewer.hpp"
+#include "Check.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+    constexpr UINT externalTriggerMessage = WM_APP + 1;
+
+    // The dump count is published just before the dumper goes idle, so a trigger right after may still be refused
+    bool triggerWhenIdle(FlightRecorder& recorder, int64_t time, FlightRecorder::Trigger reason)
+    {
+        for (int i = 0; i < 10'000; ++i)
+        {
+            if (recorder.trigger(time, reason))
+            {
+                return true;
+            }
+            Sleep(1);
+        }
+        return false;
+    }
+
+    // Waits for the dump count to reach dumps and returns the lines of the last dump, deleting its file
+    std::vector<std::string> waitForDump(const FlightRecorder& recorder, uint64_t dumps)
+    {
+        for (int i = 0; i < 10'000 && recorder.status().dumps + recorder.status().failedDumps < dumps; ++i)
+        {
+            Sleep(1);
+        }
+
+        const FlightRecorder::Status status = recorder.status();
+        std::vector<std::string> lines;
+        if (status.dumps == dumps)
+        {
+            std::ifstream file{std::filesystem::path(status.lastPath)};
+            for (std::string line; std::getline(file, line);)
+            {
+                lines.push_back(std::move(line));
+            }
+            file.close();
+            std::filesystem::remove(std::filesystem::path(status.lastPath));
+        }
+        return lines;
+    }
+} // namespace
+
+int main()
+{
+    const HWND owner = CreateWindowExW(0, L"STATIC", nullptr, 0, 0, 0, 0, 0, HWND_MESSAGE, nullptr, nullptr, nullptr);
+    CHECK(owner != nullptr);
+
+    FlightRecorder recorder(1, 3600, owner, externalTriggerMessage);
+    const int64_t frequency = PerformanceCounter::frequency();
+    int64_t time = PerformanceCounter::now();
+    const RAWKEYBOARD keyboard{.MakeCode = 0x1e, .Flags = RI_KEY_E0, .VKey = 'A'};
+
+    // A short recording is dumped in full, oldest first, relative to the trigger time
+    {
+        for (int i = 0; i < 99; ++i)
+        {
+            recorder.recordKeyboard(time += frequency / 1000, 1, keyboard);
+        }
+        RAWMOUSE mouse{.usFlags = MOUSE_MOVE_NOCOALESCE, .lLastX = -5, .lLastY = 7};
+        mouse.usButtonFlags = RI_MOUSE_LEFT_BUTTON_DOWN;
+        recorder.recordMouse(time += frequency / 1000, 3, mouse);
+        CHECK(recorder.trigger(time, FlightRecorder::Trigger::Manual));
+
+        const std::vector<std::string> lines = waitForDump(recorder, 1);
+        CHECK(lines.size() == 102);
+        CHECK(lines.size() > 2 && lines[1] == "# manual trigger");
+        CHECK(lines.size() > 2 && lines[2] == "-99.000,keyboard,1,0x001e,0x0002,0x41");
+        CHECK(!lines.empty() && lines.back() == "0.000,mouse,3,-5,7,0x0001,0,0x0008");
+    }
+
+    // A long recording keeps the newest blocks; none were lost, as nothing was recorded during the dump
+    {
+        constexpr int eventCount = 400'000;
+        for (int i = 0; i < eventCount; ++i)
+        {
+            recorder.recordKeyboard(time += frequency / 100'000, 2, keyboard);
+        }
+        CHECK(triggerWhenIdle(recorder, time, FlightRecorder::Trigger::Anomaly));
+
+        const std::vector<std::string> lines = waitForDump(recorder, 2);
+        const size_t perEvent = recorder.capacity() / (std::max<size_t>(lines.size(), 3) - 2);
+        CHECK(lines.size() > 2 && lines.size() < eventCount);
+        CHECK(perEvent >= 6 && perEvent <= 9);
+        CHECK(!lines.empty() && lines.back() == "0.000,keyboard,2,0x001e,0x0002,0x41");
+        CHECK(recorder.status().lostBlocks == 0);
+    }
+
+    // Anomalies are held off for the dump length, other triggers aren't
+    {
+        const uint64_t ignored = recorder.status().ignoredTriggers;
+        CHECK(!recorder.trigger(time + 1, FlightRecorder::Trigger::Anomaly));
+        CHECK(recorder.status().ignoredTriggers == ignored + 1);
+        CHECK(triggerWhenIdle(recorder, time + 2, FlightRecorder::Trigger::Hotkey));
+        CHECK(waitForDump(recorder, 3).size() > 2);
+    }
+
+    // Setting the event named after this process posts the trigger message to the owner
+    {
+        CHECK(FlightRecorder::externalTriggerName(1234) == L"Local\\RawInputViewer.FlightRecorder.Trigger.1234");
+        const HANDLE event = OpenEventW(EVENT_MODIFY_STATE, FALSE, FlightRecorder::externalTriggerName(GetCurrentProcessId()).c_str());
+        CHECK(event != nullptr);
+        CHECK(SetEvent(event));
+
+        MSG msg{};
+        bool posted = false;
+        for (int i = 0; i < 10'000 && !posted; ++i)
+        {
+            Sleep(1);
+            posted = PeekMessageW(&msg, owner, externalTriggerMessage, externalTriggerMessage, PM_REMOVE) != FALSE;
+        }
+        CHECK(posted);
+        CloseHandle(event);
+    }
+
+    DestroyWindow(owner);
+    return checkResult();
+}
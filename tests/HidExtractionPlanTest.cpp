@@ -0,0 +1,215 @@
+/***************************************************************************************************
+ *
+ *   RawInputViewer - A utility to test, visualize, and map WM_INPUT messages.
+ *
+ *   Copyright (c) 2025 by Bitdancer (@RealBitdancer)
+ *
+ *   Licensed under the MIT License. See LICENSE file in the repository for details.
+ *
+ *   Source: https://github.com/RealBitdancer/RawInputViewer
+ *
+ **************************************************************************************************/
+
+// Compiles report descriptor fixtures with HidDescriptorParser and extracts report fixtures with the resulting
+// HidExtractionPlan: report IDs, padding, sign extension, short reports, and fields spanning five bytes. Builds
+// without Windows.
+
+#include "RawInputViewerCore.hpp"
+#include "Check.hpp"
+
+namespace
+{
+    // Gamepad with 12 buttons and signed 16-bit X and Y in report 1, and a volume-up key in report 2
+    constexpr uint8_t gamepadDescriptor[] = {
+        0x05, 0x01,                   // Usage Page (Generic Desktop)
+        0x09, 0x05,                   // Usage (Game Pad)
+        0xa1, 0x01,                   // Collection (Application)
+        0x85, 0x01,                   //   Report ID (1)
+        0x05, 0x09,                   //   Usage Page (Button)
+        0x19, 0x01,                   //   Usage Minimum (1)
+        0x29, 0x0c,                   //   Usage Maximum (12)
+        0x15, 0x00,                   //   Logical Minimum (0)
+        0x25, 0x01,                   //   Logical Maximum (1)
+        0x75, 0x01,                   //   Report Size (1)
+        0x95, 0x0c,                   //   Report Count (12)
+        0x81, 0x02,                   //   Input (Data, Variable, Absolute)
+        0x75, 0x04,                   //   Report Size (4)
+        0x95, 0x01,                   //   Report Count (1)
+        0x81, 0x03,                   //   Input (Constant), padding
+        0x05, 0x01,                   //   Usage Page (Generic Desktop)
+        0x09, 0x30,                   //   Usage (X)
+        0x09, 0x31,                   //   Usage (Y)
+        0x16, 0x00, 0x80,             //   Logical Minimum (-32768)
+        0x26, 0xff, 0x7f,             //   Logical Maximum (32767)
+        0x75, 0x10,                   //   Report Size (16)
+        0x95, 0x02,                   //   Report Count (2)
+        0x81, 0x02,                   //   Input (Data, Variable, Absolute)
+        0x85, 0x02,                   //   Report ID (2)
+        0x05, 0x0c,                   //   Usage Page (Consumer)
+        0x09, 0xe9,                   //   Usage (Volume Increment)
+        0x15, 0x00,                   //   Logical Minimum (0)
+        0x25, 0x01,                   //   Logical Maximum (1)
+        0x75, 0x01,                   //   Report Size (1)
+        0x95, 0x01,                   //   Report Count (1)
+        0x81, 0x02,                   //   Input (Data, Variable, Absolute)
+        0x75, 0x07,                   //   Report Size (7)
+        0x81, 0x03,                   //   Input (Constant), padding
+        0xc0,                         // End Collection
+    };
+
+    // Mouse without report IDs: 3 buttons, 5 bits padding, signed 8-bit X and Y, and an 8-bit wheel whose logical
+    // maximum is encoded in a single byte
+    constexpr uint8_t mouseDescriptor[] = {
+        0x05, 0x01,                   // Usage Page (Generic Desktop)
+        0x09, 0x02,                   // Usage (Mouse)
+        0xa1, 0x01,                   // Collection (Application)
+        0x05, 0x09,                   //   Usage Page (Button)
+        0x19, 0x01,                   //   Usage Minimum (1)
+        0x29, 0x03,                   //   Usage Maximum (3)
+        0x15, 0x00,                   //   Logical Minimum (0)
+        0x25, 0x01,                   //   Logical Maximum (1)
+        0x75, 0x01,                   //   Report Size (1)
+        0x95, 0x03,                   //   Report Count (3)
+        0x81, 0x02,                   //   Input (Data, Variable, Absolute)
+        0x75, 0x05,                   //   Report Size (5)
+        0x95, 0x01,                   //   Report Count (1)
+        0x81, 0x03,                   //   Input (Constant), padding
+        0x05, 0x01,                   //   Usage Page (Generic Desktop)
+        0x09, 0x30,                   //   Usage (X)
+        0x09, 0x31,                   //   Usage (Y)
+        0x15, 0x81,                   //   Logical Minimum (-127)
+        0x25, 0x7f,                   //   Logical Maximum (127)
+        0x75, 0x08,                   //   Report Size (8)
+        0x95, 0x02,                   //   Report Count (2)
+        0x81, 0x06,                   //   Input (Data, Variable, Relative)
+        0x09, 0x38,                   //   Usage (Wheel)
+        0x15, 0x00,                   //   Logical Minimum (0)
+        0x25, 0xff,                   //   Logical Maximum (255)
+        0x95, 0x01,                   //   Report Count (1)
+        0x81, 0x06,                   //   Input (Data, Variable, Relative)
+        0xc0,                         // End Collection
+    };
+
+    bool isField(const HidField& field, uint16_t usagePage, uint16_t usage, uint8_t reportId, uint32_t bitOffset, uint8_t bitSize)
+    {
+        return field.usagePage == usagePage && field.usage == usage && field.reportId == reportId && field.bitOffset == bitOffset && field.bitSize == bitSize && !field.isArray;
+    }
+} // namespace
+
+int main()
+{
+    // Gamepad: fields follow the report ID byte, padding isn't a field
+    {
+        const HidExtractionPlan plan = HidDescriptorParser::compile(gamepadDescriptor);
+        const std::span<const HidField> fields = plan.fields();
+        CHECK(fields.size() == 15);
+        CHECK(isField(fields[0], 0x09, 1, 1, 8, 1));
+        CHECK(isField(fields[11], 0x09, 12, 1, 19, 1));
+        CHECK(isField(fields[12], 0x01, 0x30, 1, 24, 16));
+        CHECK(isField(fields[13], 0x01, 0x31, 1, 40, 16));
+        CHECK(fields[12].logicalMinimum == -32768 && fields[12].logicalMaximum == 32767);
+        CHECK(isField(fields[14], 0x0c, 0xe9, 2, 8, 1));
+
+        // Buttons 1, 3 and 12, X = -2, Y = 300
+        std::vector<int32_t> values(fields.size(), 99);
+        const uint8_t report1[] = {0x01, 0x05, 0x08, 0xfe, 0xff, 0x2c, 0x01};
+        const HidExtractionPlan::Range range = plan.extract(report1, values);
+        CHECK(range.first == 0 && range.last == 14);
+        CHECK(values[0] == 1 && values[1] == 0 && values[2] == 1 && values[10] == 0 && values[11] == 1);
+        CHECK(values[12] == -2);
+        CHECK(values[13] == 300);
+        CHECK(values[14] == 99); // Another report's field is left as it is
+
+        const uint8_t report2[] = {0x02, 0x01};
+        const HidExtractionPlan::Range volume = plan.extract(report2, values);
+        CHECK(volume.first == 14 && volume.last == 15);
+        CHECK(values[14] == 1);
+        CHECK(values[12] == -2);
+
+        // Unknown report IDs have no fields
+        const uint8_t report9[] = {0x09, 0xff, 0xff};
+        const HidExtractionPlan::Range unknown = plan.extract(report9, values);
+        CHECK(unknown.first == unknown.last);
+
+        // A short report extracts the fields it holds in full and skips the rest
+        std::ranges::fill(values, 99);
+        const uint8_t shortReport[] = {0x01, 0xff, 0x0f, 0x10, 0x00, 0x7f};
+        plan.extract(shortReport, values);
+        CHECK(values[0] == 1 && values[11] == 1);
+        CHECK(values[12] == 16);
+        CHECK(values[13] == 99);
+    }
+
+    // Mouse: without report IDs fields start at bit 0, or at bit 8 when reports carry a report ID byte anyway
+    {
+        const HidExtractionPlan plan = HidDescriptorParser::compile(mouseDescriptor);
+        const std::span<const HidField> fields = plan.fields();
+        CHECK(fields.size() == 6);
+        CHECK(isField(fields[0], 0x09, 1, 0, 0, 1));
+        CHECK(isField(fields[3], 0x01, 0x30, 0, 8, 8));
+        CHECK(isField(fields[5], 0x01, 0x38, 0, 24, 8));
+        CHECK(fields[3].logicalMinimum == -127 && fields[3].logicalMaximum == 127);
+        CHECK(fields[5].logicalMinimum == 0 && fields[5].logicalMaximum == 255);
+
+        std::vector<int32_t> values(fields.size());
+        const uint8_t report[] = {0x02, 0x81, 0x05, 0xf0};
+        plan.extract(report, values);
+        CHECK(values[0] == 0 && values[1] == 1 && values[2] == 0);
+        CHECK(values[3] == -127 && values[4] == 5);
+        CHECK(values[5] == 240); // Not sign-extended, the logical minimum isn't negative
+
+        const HidExtractionPlan prefixed = HidDescriptorParser::compile(mouseDescriptor, true);
+        CHECK(prefixed.fields()[3].bitOffset == 16);
+        const uint8_t prefixedReport[] = {0x00, 0x02, 0x81, 0x05, 0xf0};
+        std::ranges::fill(values, 0);
+        prefixed.extract(prefixedReport, values);
+        CHECK(values[1] == 1 && values[3] == -127 && values[4] == 5 && values[5] == 240);
+    }
+
+    // Fields at odd bit offsets, up to five bytes wide, with and without sign extension
+    {
+        // clang-format off
+        const HidExtractionPlan plan({
+            {.usagePage = 0xff00, .usage = 1, .reportId = 3, .isArray = false, .bitSize = 32, .bitOffset = 12, .logicalMinimum = std::numeric_limits<int32_t>::min(), .logicalMaximum = std::numeric_limits<int32_t>::max()},
+            {.usagePage = 0xff00, .usage = 2, .reportId = 3, .isArray = false, .bitSize = 28, .bitOffset = 47, .logicalMinimum = 0, .logicalMaximum = (1 << 28) - 1},
+            {.usagePage = 0xff00, .usage = 3, .reportId = 3, .isArray = false, .bitSize = 12, .bitOffset = 75, .logicalMinimum = -2048, .logicalMaximum = 2047},
+        });
+        // clang-format on
+
+        // 0x89abcdef at bit 12, 0xfedcba9 at bit 47, -3 (0xffd) at bit 75
+        std::array<uint8_t, 12> report{};
+        report[0] = 3;
+        auto put = [&report](uint64_t value, uint32_t bitOffset, uint32_t bitSize)
+        {
+            for (uint32_t bit = 0; bit < bitSize; ++bit)
+            {
+                const uint32_t at = bitOffset + bit;
+                report[at / 8] = static_cast<uint8_t>(report[at / 8] | ((value >> bit) & 1) << (at % 8));
+            }
+        };
+        put(0x89abcdef, 12, 32);
+        put(0xfedcba9, 47, 28);
+        put(0xffd, 75, 12);
+
+        std::array<int32_t, 3> values{};
+        const HidExtractionPlan::Range range = plan.extract(report, values);
+        CHECK(range.first == 0 && range.last == 3);
+        CHECK(static_cast<uint32_t>(values[0]) == 0x89abcdef);
+        CHECK(values[1] == 0xfedcba9);
+        CHECK(values[2] == -3);
+
+        // The five-byte field at bit 47 ends in byte 9; one byte less leaves it and the field after it out
+        values.fill(7);
+        plan.extract(std::span(report).first(9), values);
+        CHECK(static_cast<uint32_t>(values[0]) == 0x89abcdef);
+        CHECK(values[1] == 7 && values[2] == 7);
+    }
+
+    // Absurd report counts are capped
+    {
+        constexpr uint8_t descriptor[] = {0x06, 0x00, 0xff, 0x09, 0x01, 0x75, 0x08, 0x96, 0xff, 0xff, 0x81, 0x02};
+        CHECK(HidDescriptorParser::compile(descriptor).fields().size() == HidExtractionPlan::maxFields);
+    }
+
+    return checkResult();
+}
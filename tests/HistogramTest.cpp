@@ -0,0 +1,124 @@
+/***************************************************************************************************
+ *
+ *   RawInputViewer - A utility to test, visualize, and map WM_INPUT messages.
+ *
+ *   Copyright (c) 2025 by Bitdancer (@RealBitdancer)
+ *
+ *   Licensed under the MIT License. See LICENSE file in the repository for details.
+ *
+ *   Source: https://github.com/RealBitdancer/RawInputViewer
+ *
+ **************************************************************************************************/
+
+// Checks Histogram's percentiles against exact ones within the relative error bound, merging, and the serialized
+// form including truncated and mismatched data. Builds without Windows.
+
+#include "RawInputViewerCore.hpp"
+#include "Check.hpp"
+
+namespace
+{
+    bool isWithinError(uint64_t value, uint64_t exact)
+    {
+        return std::abs(static_cast<double>(value) - static_cast<double>(exact)) <= Histogram<>::relativeError * static_cast<double>(exact);
+    }
+} // namespace
+
+int main()
+{
+    // Values below 2^MantissaBits are exact
+    {
+        Histogram<> histogram;
+        for (uint64_t value = 1; value <= 100; ++value)
+        {
+            histogram.record(value);
+        }
+        CHECK(histogram.count() == 100);
+        CHECK(histogram.min() == 1);
+        CHECK(histogram.max() == 100);
+        CHECK(histogram.mean() == 50.5);
+        CHECK(histogram.valueAtPercentile(50.0) == 50);
+        CHECK(histogram.valueAtPercentile(99.0) == 99);
+        CHECK(histogram.valueAtPercentile(100.0) == 100);
+    }
+
+    // Larger values within the relative error, up to beyond MaxValueBits
+    {
+        Histogram<> histogram;
+        std::vector<uint64_t> values;
+        uint64_t seed = 42;
+        for (int i = 0; i < 100'000; ++i)
+        {
+            seed = seed * 6364136223846793005 + 1442695040888963407;
+            values.push_back((seed >> 24) % 50'000'000);
+        }
+        for (const uint64_t value : values)
+        {
+            histogram.record(value);
+        }
+        std::ranges::sort(values);
+        for (const double percentile : {1.0, 25.0, 50.0, 90.0, 99.0, 99.9})
+        {
+            const size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0 * static_cast<double>(values.size())));
+            CHECK(isWithinError(histogram.valueAtPercentile(percentile), values[rank - 1]));
+        }
+
+        histogram.record(uint64_t{1} << 50);
+        CHECK(histogram.max() == uint64_t{1} << 50);
+        CHECK(histogram.valueAtPercentile(100.0) == uint64_t{1} << 50);
+    }
+
+    // Empty histograms report zeros
+    {
+        const Histogram<> histogram;
+        CHECK(histogram.count() == 0 && histogram.min() == 0 && histogram.max() == 0);
+        CHECK(histogram.mean() == 0.0);
+        CHECK(histogram.valueAtPercentile(50.0) == 0);
+    }
+
+    // Merging equals recording into one
+    {
+        Histogram<> all;
+        Histogram<> even;
+        Histogram<> odd;
+        for (uint64_t value = 0; value < 10'000; ++value)
+        {
+            all.record(value * 37);
+            (value % 2 == 0 ? even : odd).record(value * 37);
+        }
+        even.merge(odd);
+        CHECK(even.count() == all.count());
+        CHECK(even.min() == all.min() && even.max() == all.max());
+        CHECK(even.mean() == all.mean());
+        CHECK(even.valueAtPercentile(75.0) == all.valueAtPercentile(75.0));
+    }
+
+    // Serialization round trip; truncated data and other bucket parameters are rejected
+    {
+        Histogram<> histogram;
+        for (uint64_t value = 1; value < 1'000'000; value = value * 3 + 1)
+        {
+            histogram.record(value);
+        }
+        std::vector<std::byte> data;
+        histogram.serialize(data);
+
+        Histogram<> copy;
+        std::span<const std::byte> in = data;
+        CHECK(copy.deserialize(in));
+        CHECK(in.empty());
+        CHECK(copy.count() == histogram.count());
+        CHECK(copy.min() == histogram.min() && copy.max() == histogram.max());
+        CHECK(copy.valueAtPercentile(50.0) == histogram.valueAtPercentile(50.0));
+
+        std::span<const std::byte> truncated = std::span<const std::byte>(data).first(data.size() - 1);
+        CHECK(!copy.deserialize(truncated));
+        CHECK(copy.count() == 0);
+
+        Histogram<5, 40> other;
+        std::span<const std::byte> mismatched = data;
+        CHECK(!other.deserialize(mismatched));
+    }
+
+    return checkResult();
+}
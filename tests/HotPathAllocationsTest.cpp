@@ -0,0 +1,127 @@
+/***************************************************************************************************
+ *
+ *   RawInputViewer - A utility to test, visualize, and map WM_INPUT messages.
+ *
+ *   Copyright (c) 2025 by Bitdancer (@RealBitdancer)
+ *
+ *   Licensed under the MIT License. See LICENSE file in the repository for details.
+ *
+ *   Source: https://github.com/RealBitdancer/RawInputViewer
+ *
+ **************************************************************************************************/
+
+// Replays 1M synthetic keyboard and mouse events through the per-event analyzers and stores twice and
+// checks that the second pass doesn't allocate at all. The first pass grows the stores' chunks, which
+// clear() keeps, so this is the steady state after a clear of the views. Until then the stores allocate
+// one chunk per column every ChunkSize events. MainWindow's list view insertion and Format stage need a
+// window and aren't covered here; a RAWINPUTVIEWER_COUNT_ALLOCATIONS build of the app reports them.
+
+#include "RawInputViewer.hpp"
+#include "Check.hpp"
+
+#include <cstdlib>
+
+void* operator new(size_t size)
+{
+    AllocationCounter::countAllocation();
+    if (void* p = std::malloc(size != 0 ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+int main()
+{
+    constexpr size_t eventCount = 1'000'000;
+    constexpr uint8_t keyboard = 0; // DeviceRegistry index
+    const int64_t interval = PerformanceCounter::frequency() / 1000;
+
+    KeyHoldTracker holdTracker;
+    HoldIntervalStore holdIntervals;
+    ChatterDetector chatterDetector;
+    RolloverAnalyzer rolloverAnalyzer;
+    PollingEstimator keyboardPolling;
+    PollingEstimator mousePolling;
+    WheelAnalyzer wheel;
+    Histogram<> latencies;
+    KeyboardEventStore keyboardEvents;
+    MouseEventStore mouseEvents;
+
+    int64_t time = PerformanceCounter::now();
+    for (const bool warmUp : {true, false})
+    {
+        if (!warmUp)
+        {
+            holdIntervals.clear();
+            keyboardEvents.clear();
+            mouseEvents.clear();
+            AllocationCounter::reset();
+        }
+
+        for (size_t i = 0; i < eventCount; ++i)
+        {
+            time += interval;
+            if (i % 2 == 0)
+            {
+                // Each key of the top letter row goes down and up in turn
+                const size_t keyEvent = i / 2;
+                const RAWKEYBOARD raw{.MakeCode = static_cast<USHORT>(0x10 + keyEvent / 2 % 10), .Flags = static_cast<USHORT>(keyEvent % 2 != 0 ? RI_KEY_BREAK : RI_KEY_MAKE)};
+                const RawKeyboard rawKbd(raw);
+                bool chatters = false;
+                {
+                    COUNT_ALLOCATIONS(HotPathStage::Normalize);
+                    keyboardPolling.onReport(time);
+                    chatters = chatterDetector.onKey(rawKbd.getLookupCode(), rawKbd.isKeyDown, time, interval / 2);
+                    rolloverAnalyzer.onKey(rawKbd.getLookupCode(), rawKbd.isKeyDown);
+                    latencies.record(static_cast<uint64_t>(i % 5000));
+                }
+                {
+                    COUNT_ALLOCATIONS(HotPathStage::Store);
+                    holdTracker.onKey(keyboard, rawKbd.getLookupCode(), rawKbd.isKeyDown, time, holdIntervals);
+                    keyboardEvents.append(keyboard, rawKbd.getLookupCode(), rawKbd.isKeyDown, time, chatters ? EventMarkers::Chatter : EventMarkers{0}, rolloverAnalyzer.pressed());
+                }
+            }
+            else
+            {
+                RAWMOUSE raw{.lLastX = static_cast<LONG>(i % 7) - 3, .lLastY = static_cast<LONG>(i % 5) - 2};
+                if (i % 101 == 1)
+                {
+                    raw.usButtonFlags = RI_MOUSE_WHEEL;
+                    raw.usButtonData = WHEEL_DELTA;
+                }
+                {
+                    COUNT_ALLOCATIONS(HotPathStage::Normalize);
+                    mousePolling.onReport(time);
+                    wheel.onMouse(raw, time);
+                }
+                {
+                    COUNT_ALLOCATIONS(HotPathStage::Store);
+                    mouseEvents.append(0, raw, time);
+                }
+            }
+        }
+    }
+
+    const uint64_t normalizeAllocations = AllocationCounter::steadyStateAllocations(HotPathStage::Normalize);
+    const uint64_t storeAllocations = AllocationCounter::steadyStateAllocations(HotPathStage::Store);
+    std::printf("%zu events: %llu analyzer and %llu store allocations after warm-up\n", eventCount, normalizeAllocations, storeAllocations);
+
+    CHECK(AllocationCounter::calls(HotPathStage::Normalize) == eventCount);
+    CHECK(AllocationCounter::calls(HotPathStage::Store) == eventCount);
+    CHECK(normalizeAllocations == 0);
+    CHECK(storeAllocations == 0);
+    CHECK(keyboardEvents.size() == eventCount / 2);
+    CHECK(mouseEvents.size() == eventCount / 2);
+    return checkResult();
+}
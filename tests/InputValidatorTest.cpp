@@ -0,0 +1,77 @@
+/***************************************************************************************************
+ *
+ *   RawInputViewer - A utility to test, visualize, and map WM_INPUT messages.
+ *
+ *   Copyright (c) 2025 by Bitdancer (@RealBitdancer)
+ *
+ *   Licensed under the MIT License. See LICENSE file in the repository for details.
+ *
+ *   Source: https://github.com/RealBitdancer/RawInputViewer
+ *
+ **************************************************************************************************/
+
+// Feeds InputValidator keyboard events and checks the markers: key-ups of keys pressed before the first event or
+// before release() aren't orphans, later unmatched key-ups are, and keys held too long, interrupted E1 sequences,
+// and time running backwards are flagged.
+
+#include "RawInputViewer.hpp"
+#include "Check.hpp"
+
+namespace
+{
+    // Without a virtual key, so the events match any keyboard layout
+    EventMarkers key(InputValidator& validator, USHORT makeCode, USHORT flags, int64_t time, const VirtualKeyTable& vkeys)
+    {
+        const RawKeyboard rawKbd(RAWKEYBOARD{.MakeCode = makeCode, .Flags = flags, .VKey = 0xff});
+        return validator.onKey(rawKbd, time, 1000, vkeys);
+    }
+} // namespace
+
+int main()
+{
+    const VirtualKeyTable vkeys;
+
+    // A lone key-up as the first event, e.g. of the Enter that started the program, isn't an orphan
+    {
+        InputValidator validator;
+        CHECK(key(validator, 0x1c, RI_KEY_BREAK, 10, vkeys) == EventMarkers{0});
+        CHECK(key(validator, 0x1c, RI_KEY_BREAK, 20, vkeys) == EventMarkers::OrphanKeyUp);
+        CHECK(key(validator, 0x1e, RI_KEY_MAKE, 30, vkeys) == EventMarkers{0});
+        CHECK(key(validator, 0x1e, RI_KEY_BREAK, 40, vkeys) == EventMarkers{0});
+        CHECK(key(validator, 0x1e, RI_KEY_BREAK, 50, vkeys) == EventMarkers::OrphanKeyUp);
+        CHECK(validator.counts().orphanKeyUps == 2);
+    }
+
+    // After release(), the next key-up of each key isn't an orphan either
+    {
+        InputValidator validator;
+        CHECK(key(validator, 0x38, RI_KEY_MAKE, 10, vkeys) == EventMarkers{0});
+        validator.release();
+        CHECK(key(validator, 0x38, RI_KEY_BREAK, 20, vkeys) == EventMarkers{0});
+        CHECK(key(validator, 0x38, RI_KEY_BREAK, 30, vkeys) == EventMarkers::OrphanKeyUp);
+    }
+
+    // A key held beyond the threshold is reported once, by its next event or by sweep()
+    {
+        InputValidator validator;
+        CHECK(key(validator, 0x1e, RI_KEY_MAKE, 10, vkeys) == EventMarkers{0});
+        CHECK(key(validator, 0x1e, RI_KEY_MAKE, 2000, vkeys) == EventMarkers::StuckKey);
+        CHECK(key(validator, 0x1e, RI_KEY_MAKE, 3000, vkeys) == EventMarkers{0});
+        CHECK(key(validator, 0x1f, RI_KEY_MAKE, 3000, vkeys) == EventMarkers{0});
+        CHECK(validator.sweep(4000, 1000) == 0);
+        CHECK(validator.sweep(4001, 1000) == 1);
+        CHECK(validator.counts().stuckKeys == 2);
+    }
+
+    // An E1 must be followed by the 0x45 of Pause, and time doesn't run backwards
+    {
+        InputValidator validator;
+        CHECK(key(validator, 0x1d, RI_KEY_E1, 10, vkeys) == EventMarkers{0});
+        CHECK(key(validator, 0x45, RI_KEY_MAKE, 10, vkeys) == EventMarkers{0});
+        CHECK(key(validator, 0x1d, RI_KEY_E1, 20, vkeys) == EventMarkers{0});
+        CHECK(key(validator, 0x1e, RI_KEY_MAKE, 20, vkeys) == EventMarkers::BrokenSequence);
+        CHECK(key(validator, 0x1e, RI_KEY_BREAK, 15, vkeys) == EventMarkers::TimeRegression);
+    }
+
+    return checkResult();
+}
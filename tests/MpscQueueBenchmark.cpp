@@ -0,0 +1,94 @@
+/***************************************************************************************************
+ *
+ *   RawInputViewer - A utility to test, visualize, and map WM_INPUT messages.
+ *
+ *   Copyright (c) 2025 by Bitdancer (@RealBitdancer)
+ *
+ *   Licensed under the MIT License. See LICENSE file in the repository for details.
+ *
+ *   Source: https://github.com/RealBitdancer/RawInputViewer
+ *
+ **************************************************************************************************/
+
+// Measures the throughput of the capture channel's MpscQueue with 1 to 16 producer threads pushing
+// 4M CapturedInput events in total, one at a time and in batches of 64 like the capture threads,
+// and checks that every event arrives once and in its producer's order. Producers retry while the
+// queue is full, so the numbers show the consumer's limit rather than drops.
+
+#include "RawInputViewer.hpp"
+#include "Check.hpp"
+
+int main()
+{
+    constexpr size_t eventCount = 4 * 1024 * 1024;
+    constexpr size_t capacity = CaptureChannel::capacity;
+
+    std::printf("%u hardware threads\n", std::thread::hardware_concurrency());
+    for (const size_t batchSize : {1, 64})
+    {
+        for (const size_t producerCount : {1, 2, 4, 8, 16})
+        {
+            MpscQueue<CapturedInput, capacity> queue;
+            const size_t perProducer = eventCount / producerCount;
+            std::atomic<bool> go{};
+            std::vector<std::jthread> producers;
+            for (size_t p = 0; p < producerCount; ++p)
+            {
+                producers.emplace_back(
+                    [&, p]
+                    {
+                        std::vector<CapturedInput> batch(batchSize);
+                        while (!go.load(std::memory_order_acquire))
+                        {
+                            YieldProcessor();
+                        }
+
+                        for (size_t i = 0; i < perProducer; i += batchSize)
+                        {
+                            const size_t size = std::min(batchSize, perProducer - i);
+                            for (size_t j = 0; j < size; ++j)
+                            {
+                                batch[j].time = static_cast<int64_t>(i + j);
+                                batch[j].header.hDevice = reinterpret_cast<HANDLE>(p);
+                            }
+
+                            while (!queue.tryPush(std::span(batch).first(size)))
+                            {
+                                std::this_thread::yield();
+                            }
+                        }
+                    });
+            }
+
+            std::vector<int64_t> next(producerCount);
+            std::array<CapturedInput, 256> events;
+            size_t total = 0;
+            bool ordered = true;
+            const int64_t start = PerformanceCounter::now();
+            go.store(true, std::memory_order_release);
+            while (total < perProducer * producerCount)
+            {
+                const size_t count = queue.pop(events);
+                for (const CapturedInput& event : std::span(events).first(count))
+                {
+                    int64_t& expected = next[reinterpret_cast<size_t>(event.header.hDevice)];
+                    ordered = ordered && event.time == expected;
+                    expected = event.time + 1;
+                }
+                total += count;
+                if (count == 0)
+                {
+                    YieldProcessor();
+                }
+            }
+            const uint64_t ns = PerformanceCounter::toNanoseconds(PerformanceCounter::now() - start);
+            producers.clear();
+
+            CHECK(ordered);
+            CHECK(total == perProducer * producerCount);
+            std::printf("batch %2zu, %2zu producers: %7.1f M events/s\n", batchSize, producerCount, static_cast<double>(total) * 1e3 / static_cast<double>(std::max<uint64_t>(ns, 1)));
+        }
+    }
+
+    return checkResult();
+}
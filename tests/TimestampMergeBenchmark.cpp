@@ -0,0 +1,86 @@
+/***************************************************************************************************
+ *
+ *   RawInputViewer - A utility to test, visualize, and map WM_INPUT messages.
+ *
+ *   Copyright (c) 2025 by Bitdancer (@RealBitdancer)
+ *
+ *   Licensed under the MIT License. See LICENSE file in the repository for details.
+ *
+ *   Source: https://github.com/RealBitdancer/RawInputViewer
+ *
+ **************************************************************************************************/
+
+// Measures the throughput of TimestampMerge for 2 to 64 sources of 16M events in total, handed over in
+// batches of a ChunkedColumn chunk, against sorting the concatenated timestamps, and checks the order
+// of the merged stream.
+
+#include "RawInputViewer.hpp"
+#include "Check.hpp"
+
+#include <random>
+
+int main()
+{
+    constexpr size_t eventCount = 16 * 1024 * 1024;
+    constexpr size_t batchSize = 65536;
+
+    for (const size_t sourceCount : {2, 4, 8, 16, 64})
+    {
+        // Random gaps of up to 1 ms at 10 MHz, so the sources interleave finely
+        std::mt19937_64 random(sourceCount);
+        std::uniform_int_distribution<int64_t> gap(1, 10'000);
+        std::vector<std::vector<int64_t>> sources(sourceCount);
+        for (std::vector<int64_t>& source : sources)
+        {
+            source.resize(eventCount / sourceCount);
+            int64_t time = 0;
+            for (int64_t& t : source)
+            {
+                t = time += gap(random);
+            }
+        }
+
+        TimestampMerge merge(sourceCount);
+        std::vector<TimestampMerge::Event> events(4096);
+        size_t total = 0;
+        bool ordered = true;
+        int64_t last = std::numeric_limits<int64_t>::min();
+
+        const int64_t mergeStart = PerformanceCounter::now();
+        for (size_t s = 0; s < sourceCount; ++s)
+        {
+            for (size_t offset = 0; offset < sources[s].size(); offset += batchSize)
+            {
+                merge.push(s, std::span(sources[s]).subspan(offset, std::min(batchSize, sources[s].size() - offset)));
+            }
+            merge.close(s);
+        }
+        while (const size_t count = merge.pop(events))
+        {
+            for (const TimestampMerge::Event& event : std::span(events).first(count))
+            {
+                ordered = ordered && event.time >= last;
+                last = event.time;
+            }
+            total += count;
+        }
+        const uint64_t mergeNs = PerformanceCounter::toNanoseconds(PerformanceCounter::now() - mergeStart);
+
+        std::vector<int64_t> all;
+        all.reserve(eventCount);
+        const int64_t sortStart = PerformanceCounter::now();
+        for (const std::vector<int64_t>& source : sources)
+        {
+            all.insert(all.end(), source.begin(), source.end());
+        }
+        std::ranges::sort(all);
+        const uint64_t sortNs = PerformanceCounter::toNanoseconds(PerformanceCounter::now() - sortStart);
+
+        CHECK(ordered);
+        CHECK(total == eventCount);
+        std::printf("%2zu sources: merge %7.1f M events/s, sort %7.1f M events/s\n", sourceCount, static_cast<double>(total) * 1e3 / static_cast<double>(std::max<uint64_t>(mergeNs, 1)),
+            static_cast<double>(all.size()) * 1e3 / static_cast<double>(std::max<uint64_t>(sortNs, 1)));
+    }
+
+    return checkResult();
+}
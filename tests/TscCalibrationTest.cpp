@@ -0,0 +1,134 @@
+/***************************************************************************************************
+ *
+ *   RawInputViewer - A utility to test, visualize, and map WM_INPUT messages.
+ *
+ *   Copyright (c) 2025 by Bitdancer (@RealBitdancer)
+ *
+ *   Licensed under the MIT License. See LICENSE file in the repository for details.
+ *
+ *   Source: https://github.com/RealBitdancer/RawInputViewer
+ *
+ **************************************************************************************************/
+
+// Calibrates TscCalibration against a simulated 10 MHz counter and TSC, and checks that it uses a steady invariant
+// TSC, falls back to the counter without one or when the TSC rate changes during calibration, and that recalibration
+// refines the estimate but ignores a reset or drifting TSC. Builds without Windows.
+
+#include "RawInputViewerCore.hpp"
+#include "Check.hpp"
+
+#include <functional>
+
+namespace
+{
+    constexpr int64_t counterFrequency = 10'000'000;
+    constexpr double tscFrequency = 3'000'000'000.0;
+
+    // Simulated time advances by a counter tick with each counter read; the TSC is a function of the time
+    struct Simulation
+    {
+        bool isInvariant{true};
+        int64_t counter{1'000'000};
+        std::function<double(int64_t)> tscAt = [](int64_t counter) { return static_cast<double>(counter) * (tscFrequency / counterFrequency); };
+    };
+
+    struct SimulatedClock
+    {
+        [[nodiscard]] uint64_t readTsc() const noexcept
+        {
+            return static_cast<uint64_t>(simulation->tscAt(simulation->counter));
+        }
+
+        [[nodiscard]] int64_t readCounter() const noexcept
+        {
+            return ++simulation->counter;
+        }
+
+        [[nodiscard]] int64_t counterFrequency() const noexcept
+        {
+            return ::counterFrequency;
+        }
+
+        [[nodiscard]] bool hasInvariantTsc() const noexcept
+        {
+            return simulation->isInvariant;
+        }
+
+        Simulation* simulation{};
+    };
+
+    bool isNear(int64_t value, double expected, double tolerance)
+    {
+        return std::abs(static_cast<double>(value) - expected) <= tolerance * expected;
+    }
+} // namespace
+
+int main()
+{
+    // A steady invariant TSC is used, at its frequency
+    {
+        Simulation simulation;
+        TscCalibration<SimulatedClock> calibration(SimulatedClock{&simulation});
+        CHECK(calibration.isTsc());
+        CHECK(isNear(calibration.frequency(), tscFrequency, 1e-5));
+
+        // A minute later the estimate is closer still
+        simulation.counter += 60 * counterFrequency;
+        calibration.recalibrate();
+        CHECK(isNear(calibration.frequency(), tscFrequency, 1e-7));
+    }
+
+    // Without an invariant TSC, ticks are counter ticks
+    {
+        Simulation simulation{.isInvariant = false};
+        TscCalibration<SimulatedClock> calibration(SimulatedClock{&simulation});
+        CHECK(!calibration.isTsc());
+        CHECK(calibration.frequency() == counterFrequency);
+
+        simulation.counter += 60 * counterFrequency;
+        calibration.recalibrate();
+        CHECK(calibration.frequency() == counterFrequency);
+    }
+
+    // A TSC slowing down by 1% between the two startup measurements isn't trusted
+    {
+        Simulation simulation;
+        const int64_t start = simulation.counter;
+        simulation.tscAt = [start](int64_t counter)
+        {
+            const int64_t knee = start + counterFrequency / 100;
+            const double rate = tscFrequency / counterFrequency;
+            return counter <= knee ? static_cast<double>(counter) * rate : static_cast<double>(knee) * rate + static_cast<double>(counter - knee) * rate * 0.99;
+        };
+        TscCalibration<SimulatedClock> calibration(SimulatedClock{&simulation});
+        CHECK(!calibration.isTsc());
+        CHECK(calibration.frequency() == counterFrequency);
+    }
+
+    // Recalibration keeps the estimate when the TSC was reset, e.g. on resume, or has drifted beyond tolerance
+    {
+        Simulation simulation;
+        TscCalibration<SimulatedClock> calibration(SimulatedClock{&simulation});
+        const int64_t calibrated = calibration.frequency();
+
+        simulation.tscAt = [](int64_t) { return 1000.0; };
+        simulation.counter += 60 * counterFrequency;
+        calibration.recalibrate();
+        CHECK(calibration.frequency() == calibrated);
+
+        simulation.tscAt = [](int64_t counter) { return static_cast<double>(counter) * (tscFrequency / counterFrequency) * 1.01; };
+        calibration.recalibrate();
+        CHECK(calibration.frequency() == calibrated);
+    }
+
+    // Conversion to nanoseconds is exact and doesn't overflow for a year of 3 GHz ticks
+    {
+        CHECK(ticksToNanoseconds(counterFrequency, counterFrequency) == 1'000'000'000);
+        CHECK(ticksToNanoseconds(1, counterFrequency) == 100);
+        CHECK(ticksToNanoseconds(3, 3'000'000'000) == 1);
+        constexpr int64_t year = 365 * 24 * 3600;
+        CHECK(ticksToNanoseconds(year * 3'000'000'000 + 1'500'000'000, 3'000'000'000) == static_cast<uint64_t>(year) * 1'000'000'000 + 500'000'000);
+    }
+
+    return checkResult();
+}